@@ -1,11 +1,13 @@
 #include "adl.h"
+#include "adl_mock.h"
+#include <cstdlib>
 #include <iostream>
+#ifdef _WIN32
 #include <tchar.h>
+#endif
 
 
 
-LPAdapterInfo		lpAdapterInfo = NULL;
-LPADLDisplayInfo	lpAdlDisplayInfo = NULL;
 ADLPROCS adlprocs = { 0,0,0,0 };
 
 void* __stdcall ADL_Main_Memory_Alloc(int iSize)
@@ -25,10 +27,14 @@ void __stdcall ADL_Main_Memory_Free(void** lpBuffer)
 
 bool InitADL()
 {
-    // If already initialized, return success
+    // If already initialized (or the mock is installed), return success
     if (adlprocs.hModule)
         return true;
 
+#ifndef _WIN32
+    std::cerr << "Error: ADL is only available on Windows (or with an ADL mock installed)";
+    return false;
+#else
     int	ADL_Err = ADL_ERR;
     
     adlprocs.hModule = LoadLibrary(_T("atiadlxx.dll"));
@@ -64,15 +70,15 @@ bool InitADL()
     ADL_Err = adlprocs.ADL_Main_Control_Create(ADL_Main_Memory_Alloc, 1);
 
     return (ADL_OK == ADL_Err) ? true : false;
+#endif
 }
 
 void FreeADL()
 {
-
-    ADL_Main_Memory_Free((void**)&lpAdapterInfo);
-    ADL_Main_Memory_Free((void**)&lpAdlDisplayInfo);
-
     adlprocs.ADL_Main_Control_Destroy();
-    FreeLibrary(adlprocs.hModule);
+#ifdef _WIN32
+    if (!AdlMockInstalled())
+        FreeLibrary(adlprocs.hModule);
+#endif
     adlprocs.hModule = NULL;
 }
@@ -2,9 +2,18 @@
 #ifndef ADL_H
 #define ADL_H
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+// No ADL runtime outside Windows; the table can only be filled by the mock (adl_mock.h)
+#ifndef __stdcall
+#define __stdcall
+#endif
+typedef void* HMODULE;
+#endif
+
 #include "../adl-sdk/include/adl_defines.h"
 #include "../adl-sdk/include/adl_sdk.h"
-#include <windows.h>
 
 typedef int (*ADL_MAIN_CONTROL_CREATE)(ADL_MAIN_MALLOC_CALLBACK, int);
 typedef int (*ADL_MAIN_CONTROL_DESTROY)();
@@ -26,9 +35,6 @@ typedef struct _ADLPROCS
     ADL_DISPLAY_EDIDDATA_GET			ADL_Display_EdidData_Get;
 } ADLPROCS;
 
-extern LPAdapterInfo	lpAdapterInfo;
-extern LPADLDisplayInfo	lpAdlDisplayInfo;
-
 extern ADLPROCS adlprocs;
 
 void* __stdcall ADL_Main_Memory_Alloc(int);
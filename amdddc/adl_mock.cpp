@@ -0,0 +1,290 @@
+#include "adl_mock.h"
+#include "adl.h"
+#include "ddc_transport.h"
+#include "../external/json.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+static AdlMockConfig g_cfg;
+static std::unique_ptr<DdcTransport> g_monitors;   // answers DDC/CI frames
+static ADL_MAIN_MALLOC_CALLBACK g_alloc = nullptr;
+static bool g_installed = false;
+static int g_moduleTag;                            // stands in for the DLL handle
+
+static std::mutex g_statsLock;
+static std::map<std::string, AdlMockCallStats> g_stats;
+
+// ---------- Injection ----------
+
+// Applies the scripted latency and decides whether this call fails
+static int Enter(const char* fn)
+{
+    AdlMockCall call;
+    auto it = g_cfg.calls.find(fn);
+    if (it != g_cfg.calls.end()) call = it->second;
+
+    if (call.latencyUs)
+        std::this_thread::sleep_for(std::chrono::microseconds(call.latencyUs));
+
+    std::lock_guard<std::mutex> lock(g_statsLock);
+    AdlMockCallStats& s = g_stats[fn];
+    ++s.calls;
+    s.latencyUs += call.latencyUs;
+    if (call.error != ADL_OK && call.failEvery && s.calls % call.failEvery == 0) {
+        ++s.failures;
+        return call.error;
+    }
+    return ADL_OK;
+}
+
+static const AdlMockAdapter* FindAdapter(int index)
+{
+    for (const auto& a : g_cfg.adapters)
+        if (a.index == index) return &a;
+    return nullptr;
+}
+
+static const AdlMockDisplay* FindDisplay(int adapterIdx, int displayIdx)
+{
+    const AdlMockAdapter* a = FindAdapter(adapterIdx);
+    if (!a) return nullptr;
+    for (const auto& d : a->displays)
+        if (d.index == displayIdx) return &d;
+    return nullptr;
+}
+
+static void CopyName(char* dst, const std::string& src)
+{
+    strncpy(dst, src.c_str(), ADL_MAX_PATH - 1);
+    dst[ADL_MAX_PATH - 1] = '\0';
+}
+
+// ---------- ADL entry points ----------
+
+static int MockControlCreate(ADL_MAIN_MALLOC_CALLBACK alloc, int)
+{
+    int rc = Enter("ADL_Main_Control_Create");
+    if (rc != ADL_OK) return rc;
+    g_alloc = alloc;
+    return ADL_OK;
+}
+
+static int MockControlDestroy()
+{
+    return Enter("ADL_Main_Control_Destroy");
+}
+
+static int MockNumberOfAdapters(int* count)
+{
+    int rc = Enter("ADL_Adapter_NumberOfAdapters_Get");
+    if (rc != ADL_OK) return rc;
+    if (!count) return ADL_ERR_NULL_POINTER;
+    *count = (int)g_cfg.adapters.size();
+    return ADL_OK;
+}
+
+static int MockAdapterInfo(LPAdapterInfo info, int size)
+{
+    int rc = Enter("ADL_Adapter_AdapterInfo_Get");
+    if (rc != ADL_OK) return rc;
+    if (!info) return ADL_ERR_NULL_POINTER;
+    if (size < (int)(sizeof(AdapterInfo) * g_cfg.adapters.size())) return ADL_ERR_INVALID_PARAM_SIZE;
+
+    for (size_t i = 0; i < g_cfg.adapters.size(); ++i) {
+        const AdlMockAdapter& a = g_cfg.adapters[i];
+        AdapterInfo& out = info[i];
+        memset(&out, 0, sizeof(out));
+        out.iSize = sizeof(AdapterInfo);
+        out.iAdapterIndex = a.index;
+        out.iBusNumber = a.bus;
+        out.iVendorID = 1002;
+        out.iPresent = 1;
+        CopyName(out.strAdapterName, a.name);
+    }
+    return ADL_OK;
+}
+
+static int MockDisplayInfo(int adapterIdx, int* count, ADLDisplayInfo** info, int)
+{
+    int rc = Enter("ADL_Display_DisplayInfo_Get");
+    if (rc != ADL_OK) return rc;
+    if (!count || !info) return ADL_ERR_NULL_POINTER;
+    const AdlMockAdapter* self = FindAdapter(adapterIdx);
+    if (!self) return ADL_ERR_INVALID_ADL_IDX;
+
+    std::vector<ADLDisplayInfo> list;
+    for (const auto& a : g_cfg.adapters) {
+        if (a.bus != self->bus) continue;
+        for (const auto& d : a.displays) {
+            ADLDisplayInfo di;
+            memset(&di, 0, sizeof(di));
+            di.displayID.iDisplayLogicalIndex = d.index;
+            di.displayID.iDisplayPhysicalIndex = d.index;
+            di.displayID.iDisplayLogicalAdapterIndex = a.index;
+            di.displayID.iDisplayPhysicalAdapterIndex = a.index;
+            CopyName(di.strDisplayName, d.name);
+            CopyName(di.strDisplayManufacturerName, d.id.manufacturer);
+            di.iDisplayInfoMask = ADL_DISPLAY_DISPLAYINFO_DISPLAYCONNECTED | ADL_DISPLAY_DISPLAYINFO_DISPLAYMAPPED;
+            di.iDisplayInfoValue = (d.connected ? ADL_DISPLAY_DISPLAYINFO_DISPLAYCONNECTED : 0) |
+                (d.mapped ? ADL_DISPLAY_DISPLAYINFO_DISPLAYMAPPED : 0);
+            list.push_back(di);
+        }
+    }
+
+    // The caller frees with ADL_Main_Memory_Free, so allocate the way the driver would
+    *count = (int)list.size();
+    *info = nullptr;
+    if (list.empty()) return ADL_OK;
+    const int bytes = (int)(sizeof(ADLDisplayInfo) * list.size());
+    *info = (ADLDisplayInfo*)(g_alloc ? g_alloc(bytes) : malloc((size_t)bytes));
+    if (!*info) return ADL_ERR;
+    memcpy(*info, list.data(), (size_t)bytes);
+    return ADL_OK;
+}
+
+static int MockDdcBlockAccess(int adapterIdx, int displayIdx, int, int, int sendLen, char* send,
+    int* recvLen, char* recv)
+{
+    int rc = Enter("ADL_Display_DDCBlockAccess_Get");
+    if (rc != ADL_OK) return rc;
+    const AdlMockDisplay* d = FindDisplay(adapterIdx, displayIdx);
+    if (!d) return FindAdapter(adapterIdx) ? ADL_ERR_INVALID_DIPLAY_IDX : ADL_ERR_INVALID_ADL_IDX;
+    if (!d->connected) return ADL_ERR;  // nothing answers on the bus
+
+    if (!recv)
+        return g_monitors->Write(adapterIdx, displayIdx, (const unsigned char*)send, sendLen);
+    return g_monitors->WriteRead(adapterIdx, displayIdx, (const unsigned char*)send, sendLen,
+        (unsigned char*)recv, recvLen);
+}
+
+static int MockEdidData(int adapterIdx, int displayIdx, ADLDisplayEDIDData* edid)
+{
+    int rc = Enter("ADL_Display_EdidData_Get");
+    if (rc != ADL_OK) return rc;
+    if (!edid) return ADL_ERR_NULL_POINTER;
+    const AdlMockDisplay* d = FindDisplay(adapterIdx, displayIdx);
+    if (!d) return FindAdapter(adapterIdx) ? ADL_ERR_INVALID_DIPLAY_IDX : ADL_ERR_INVALID_ADL_IDX;
+    if (!d->connected || edid->iBlockIndex != 0) return ADL_ERR_INVALID_PARAM; // base block only
+
+    unsigned char block[EDID_BLOCK_SIZE];
+    BuildEdidBlock(d->id, d->name, block);
+    memcpy(edid->cEDIDData, block, EDID_BLOCK_SIZE);
+    edid->iEDIDSize = EDID_BLOCK_SIZE;
+    return ADL_OK;
+}
+
+// ---------- Script ----------
+
+bool ParseAdlMockScript(const std::string& text, AdlMockConfig& out, std::string* error)
+{
+    try {
+        const nlohmann::json j = nlohmann::json::parse(text);
+        AdlMockConfig c;
+
+        for (const auto& ja : j.at("adapters")) {
+            AdlMockAdapter a;
+            a.index = ja.at("index").get<int>();
+            a.bus = ja.value("bus", a.index);
+            a.name = ja.value("name", std::string("Mock ADL Adapter"));
+            if (ja.contains("displays")) {
+                for (const auto& jd : ja["displays"]) {
+                    AdlMockDisplay d;
+                    d.index = jd.at("index").get<int>();
+                    d.name = jd.value("name", std::string("Mock Display"));
+                    d.id.manufacturer = jd.value("manufacturer", std::string("GSM"));
+                    d.id.product = (unsigned short)jd.value("product", 0u);
+                    d.id.serial = jd.value("serial", 0u);
+                    d.id.serialText = jd.value("serialText", std::string());
+                    d.connected = jd.value("connected", true);
+                    d.mapped = jd.value("mapped", true);
+                    a.displays.push_back(d);
+                }
+            }
+            c.adapters.push_back(a);
+        }
+
+        c.monitor.switchMs = j.value("inputSwitchMs", 0u);
+        std::string modelError;
+        if (j.contains("monitor") && !ParseSimMonitorModel(j["monitor"].get<std::string>(), c.monitor, &modelError))
+            throw std::runtime_error("monitor: " + modelError);
+        if (j.contains("calls")) {
+            for (auto it = j["calls"].begin(); it != j["calls"].end(); ++it) {
+                AdlMockCall call;
+                call.latencyUs = it.value().value("latencyUs", 0u);
+                call.error = it.value().value("error", (int)ADL_OK);
+                call.failEvery = it.value().value("failEvery", 1u);
+                c.calls[it.key()] = call;
+            }
+        }
+
+        out = std::move(c);
+        return true;
+    }
+    catch (const std::exception& e) {
+        if (error) *error = e.what();
+        return false;
+    }
+}
+
+bool LoadAdlMockScript(const std::string& path, AdlMockConfig& out, std::string* error)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ParseAdlMockScript(ss.str(), out, error);
+}
+
+// ---------- Install ----------
+
+void InstallAdlMock(const AdlMockConfig& cfg)
+{
+    g_cfg = cfg;
+    SimTransportOptions opts;
+    opts.model = cfg.monitor;
+    g_monitors = CreateSimTransport(opts);
+    g_alloc = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_statsLock);
+        g_stats.clear();
+    }
+
+    adlprocs.hModule = (HMODULE)&g_moduleTag;
+    adlprocs.ADL_Main_Control_Create = MockControlCreate;
+    adlprocs.ADL_Main_Control_Destroy = MockControlDestroy;
+    adlprocs.ADL_Adapter_NumberOfAdapters_Get = MockNumberOfAdapters;
+    adlprocs.ADL_Adapter_AdapterInfo_Get = MockAdapterInfo;
+    adlprocs.ADL_Display_DisplayInfo_Get = MockDisplayInfo;
+    adlprocs.ADL_Display_DDCBlockAccess_Get = MockDdcBlockAccess;
+    adlprocs.ADL_Display_EdidData_Get = MockEdidData;
+    g_installed = true;
+}
+
+void RemoveAdlMock()
+{
+    if (!g_installed) return;
+    adlprocs = ADLPROCS{};
+    g_monitors.reset();
+    g_installed = false;
+}
+
+bool AdlMockInstalled()
+{
+    return g_installed;
+}
+
+std::map<std::string, AdlMockCallStats> GetAdlMockStats()
+{
+    std::lock_guard<std::mutex> lock(g_statsLock);
+    return g_stats;
+}
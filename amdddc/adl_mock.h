@@ -0,0 +1,80 @@
+#pragma once
+#ifndef ADL_MOCK_H
+#define ADL_MOCK_H
+
+#include "ddc_edid.h"
+#include "ddc_sim_monitor.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// Stand-in ADL: fills the adlprocs table with in-process functions answering from a
+// scripted topology, so the adapter walk, EDID reads and DDC switching run (and can be
+// timed) without atiadlxx.dll, including on Linux. DDC/CI frames are answered by the
+// sim transport's monitor model.
+//
+// Script (JSON):
+//   {
+//     "adapters": [
+//       { "index": 5, "bus": 3, "name": "AMD Radeon RX 7800 XT",
+//         "displays": [ { "index": 0, "name": "LG ULTRAGEAR+", "manufacturer": "GSM",
+//                         "product": 23465, "serial": 1, "serialText": "", "connected": true } ] },
+//       { "index": 6, "bus": 3, "name": "AMD Radeon RX 7800 XT" }
+//     ],
+//     "inputSwitchMs": 150,
+//     "monitor": "jitter=40,busy=60,nak=0.01",
+//     "calls": { "ADL_Display_DDCBlockAccess_Get": { "latencyUs": 2000, "error": -12, "failEvery": 10 } }
+//   }
+//
+// Like the real driver, ADL_Display_DisplayInfo_Get on any adapter entry returns the
+// displays of every entry on the same bus, tagged with their logical adapter.
+// "monitor" is a ParseSimMonitorModel spec for the simulated monitors (ddc_sim_monitor.h);
+// "inputSwitchMs" is its switch time.
+
+struct AdlMockDisplay {
+    int index = 0;
+    std::string name;
+    EdidIdentity id;
+    bool connected = true;
+    bool mapped = true;
+};
+
+struct AdlMockAdapter {
+    int index = 0;
+    int bus = 0;
+    std::string name;
+    std::vector<AdlMockDisplay> displays;
+};
+
+// Injected per-function behaviour. error is returned on every failEvery-th call
+// (1 = always); latency applies to every call, failed or not.
+struct AdlMockCall {
+    unsigned int latencyUs = 0;
+    int error = 0;              // ADL_OK
+    unsigned int failEvery = 1;
+};
+
+struct AdlMockConfig {
+    std::vector<AdlMockAdapter> adapters;
+    DdcSimMonitorModel monitor;
+    std::map<std::string, AdlMockCall> calls; // keyed by ADL function name
+};
+
+struct AdlMockCallStats {
+    unsigned long long calls = 0;
+    unsigned long long failures = 0;
+    unsigned long long latencyUs = 0; // injected latency only
+};
+
+bool ParseAdlMockScript(const std::string& json, AdlMockConfig& out, std::string* error = nullptr);
+bool LoadAdlMockScript(const std::string& path, AdlMockConfig& out, std::string* error = nullptr);
+
+// Replaces the adlprocs table; InitADL then succeeds without loading the driver.
+// Resets the call statistics and the simulated monitors.
+void InstallAdlMock(const AdlMockConfig& cfg);
+void RemoveAdlMock();
+bool AdlMockInstalled();
+
+std::map<std::string, AdlMockCallStats> GetAdlMockStats();
+
+#endif // !ADL_MOCK_H
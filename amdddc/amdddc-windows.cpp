@@ -1,126 +1,597 @@
 #include "settings.h"
 #include "adl.h"
+#include "adl_mock.h"
+#include "amdddc_core.h"
+#include "ddc_bus.h"
+#include "ddc_caps.h"
+#include "ddc_identity.h"
+#include "ddc_metrics.h"
+#include "ddc_retry.h"
+#include "ddc_server.h"
+#include "ddc_trace.h"
+#include "ddc_transport.h"
+#include "../external/json.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <csignal>
+#include <pthread.h>
+#endif
 
 using namespace std;
+using json = nlohmann::json;
 
 #pragma region setvcp command
-#define SETWRITESIZE 8
-#define SET_VCPCODE_SUBADDRESS 1
-#define SET_VCPCODE_OFFSET 4
-#define SET_HIGH_OFFSET 5
-#define SET_LOW_OFFSET 6
-#define SET_CHK_OFFSET 7
 #define VCP_CODE_SWITCH_INPUT 0xF4
+#define VCP_CODE_INPUT_SELECT 0x60
 
-unsigned char ucSetCommandWrite[SETWRITESIZE] = { 0x6e,0x51,0x84,0x03,0x00,0x00,0x00,0x00 };
+// Upper bound on how long setvcp waits for the monitor to confirm the new input
+#define SETVCP_SETTLE_DEADLINE_MS 5000
 
-int vWriteI2c(char* lpucSendMsgBuf, int iSendMsgLen, int iAdapterIndex, int iDisplayIndex)
+// Outcome of a switch that went through, local or on the serve daemon
+static void print_switch_result(unsigned int vcpCode, const DdcSwitchResult& res)
 {
-    int iRev = 0;
-    return adlprocs.ADL_Display_DDCBlockAccess_Get(iAdapterIndex, iDisplayIndex, NULL, NULL, iSendMsgLen, lpucSendMsgBuf, &iRev, NULL);
+    const bool input = vcpCode == VCP_CODE_SWITCH_INPUT || vcpCode == VCP_CODE_INPUT_SELECT;
+    const char* what = input ? "Input" : "Value";
+    if (res.alreadyActive)
+        cout << (input ? "Monitor already on the requested input" : "Monitor already at the requested value") << endl;
+    else if (res.confirmed)
+        cout << what << " confirmed after " << dec << res.latencyMs << " ms (" << res.polls << " polls)" << endl;
+    else
+        cout << what << " not confirmed by monitor; waited " << dec << res.latencyMs << " ms" << endl;
+    if (res.attempts > 1)
+        cout << "Write attempts: " << dec << res.attempts << endl;
 }
 
-void vSetVcpCommand(unsigned int subaddress, unsigned char ucVcp, unsigned int ulVal, int iAdapterIndex, int iDisplayIndex)
+// --wait none / <ms>: the value went out without a readback
+static void print_unverified_write(int waitMs)
 {
-    unsigned int i;
-    unsigned char chk = 0;
-    int ADL_Err = ADL_ERR;
-    /*
-    * Following DDC/CI Spec defined here: https://boichat.ch/nicolas/ddcci/specs.html
-    *
-    UCHAR ucSetCommandWrite[8] =
-    0: 0x6e - I2C address     : 0x37, writing
-    1: 0x51 - I2C sub address : Using 0x50 for input switching on LG
-    2: 0x84 - For writes, the last 4 bits indicates the number of following bytes, excluding checksum (so, 0x84 is 0b10000100 or 4)
-    3: 0x03
-    4: 0x00 - Side Channel Code, so 0xF4
-    5: 0x00 - 0x00 -- ?? Guessing if the code is > 255
-    6: 0x00 - 0xD2 -- Display Code
-    7: 0x00 - Checksum using XOR of all preceding bytes, including the first
-    */
+    cout << "Value written, not read back";
+    if (waitMs > 0)
+        cout << "; waited " << dec << waitMs << " ms";
+    cout << endl;
+}
 
-    /*
-    * Display codes:
-    * 0x00 - Auto?
-    * 0xD0 - DP1, Confirmed
-    * 0xD1 - USB-C, Confirmed (It's the DP-2 Alt, but DualUp doesn't have it)
-    * 0x90 - HDMI, Confiremed
-    * 0x91 - HDMI2, Confirmed
-    */
+int vSetVcpCommand(unsigned int subaddress, unsigned int vcpCode, unsigned int ulVal, int iAdapterIndex, int iDisplayIndex, int waitMs)
+{
+    // --wait none / <ms>: just the write (with retries), then optionally a fixed pause
+    if (waitMs >= 0) {
+        int rc = SetVcpValueWithI2cAddr(iAdapterIndex, iDisplayIndex, (unsigned short)vcpCode, ulVal, subaddress);
+        if (rc != 0) {
+            cerr << "setvcp failed: " << dec << rc << endl;
+            return rc;
+        }
+        if (waitMs > 0)
+            this_thread::sleep_for(chrono::milliseconds(waitMs));
+        print_unverified_write(waitMs);
+        return 0;
+    }
 
-    ucSetCommandWrite[SET_VCPCODE_SUBADDRESS] = subaddress;
+    DdcSwitchResult res{};
+    int rc = SetVcpFeatureWithI2cAddrEx(iAdapterIndex, iDisplayIndex, (unsigned short)vcpCode, ulVal, subaddress,
+        SETVCP_SETTLE_DEADLINE_MS, &res);
+    if (rc != 0) {
+        cerr << "setvcp failed: " << rc << " (" << DdcErrorClassName((DdcErrorClass)res.errorClass)
+             << ", " << res.attempts << " attempts)" << endl;
+        return rc;
+    }
+    print_switch_result(vcpCode, res);
+    return 0;
+}
 
-    ucSetCommandWrite[SET_VCPCODE_OFFSET] = ucVcp;
-    ucSetCommandWrite[SET_LOW_OFFSET] = (char)(ulVal & 0x0ff);
-    ucSetCommandWrite[SET_HIGH_OFFSET] = (char)((ulVal >> 8) & 0x0ff);
+int vGetVcpCommand(unsigned int subaddress, unsigned int vcpCode, int iAdapterIndex, int iDisplayIndex)
+{
+    unsigned int cur = 0, max = 0;
+    int rc = GetVcpFeatureWithI2cAddr(iAdapterIndex, iDisplayIndex, (unsigned short)vcpCode, subaddress, &cur, &max);
+    if (rc != 0) {
+        cerr << "getvcp failed: " << dec << rc << endl;
+        return 1;
+    }
+    cout << "VCP 0x" << hex << vcpCode << ": current 0x" << cur << ", max 0x" << max << endl;
+    return 0;
+}
+#pragma endregion
+
+#pragma region caps command
 
-    for (i = 0; i < SET_CHK_OFFSET; i++)
-        chk = chk ^ ucSetCommandWrite[i];
+int vCapsCommand(unsigned int subaddress, const string& cachePath, int iAdapterIndex, int iDisplayIndex)
+{
+    DdcCapabilities caps;
+    bool fromCache = false;
+    int rc = GetCapabilities(iAdapterIndex, iDisplayIndex, subaddress, cachePath, caps, &fromCache);
+    if (rc != 0) {
+        cerr << "caps failed: " << dec << rc << endl;
+        return 1;
+    }
 
-    ucSetCommandWrite[SET_CHK_OFFSET] = chk;
-    ADL_Err = vWriteI2c((char*)&ucSetCommandWrite[0], SETWRITESIZE, iAdapterIndex, iDisplayIndex);
-    Sleep(5000);
+    cout << "Model: " << (caps.model.empty() ? "(unknown)" : caps.model)
+         << (fromCache ? " (cached)" : "") << endl;
+    if (!caps.mccsVersion.empty()) cout << "MCCS version: " << caps.mccsVersion << endl;
+    cout << "VCP codes:" << endl;
+    for (const auto& kv : caps.vcp) {
+        cout << "  0x" << hex << (unsigned int)kv.first;
+        if (!kv.second.empty()) {
+            cout << ":";
+            for (unsigned short v : kv.second) cout << " 0x" << v;
+        }
+        cout << endl;
+    }
+    cout << "Raw: " << caps.raw << endl;
+    return 0;
 }
 #pragma endregion
 
-#pragma region detect commnad
+#pragma region detect command
 
-void print_devices() {
-    int iNumberAdapters = 0;
-    int iAdapterIndex = 0;
-    int iNumberDisplays = 0;
-	int iDisplayIndex = 0;
-    int ADL_Err = ADL_ERR;
+// Text for people, JSON (--json) for tools. Both come from the same reentrant walk the
+// tray's display service uses, over whichever transport is active.
+int print_devices(bool asJson) {
+    const vector<IdentifiedAdapter> adapters = EnumerateTopology();
 
-    adlprocs.ADL_Adapter_NumberOfAdapters_Get(&iNumberAdapters);
+    if (asJson) {
+        json out = json::array();
+        for (const auto& a : adapters) {
+            json displays = json::array();
+            for (const auto& d : a.displays) {
+                json id = nullptr;
+                if (d.id.Valid()) {
+                    id = { { "manufacturer", d.id.manufacturer }, { "product", d.id.product },
+                           { "serial", d.id.serial }, { "serialText", d.id.serialText } };
+                }
+                displays.push_back({ { "display", d.displayIdx }, { "name", d.name }, { "edid", id } });
+            }
+            out.push_back({ { "adapter", a.adapterIdx }, { "name", a.name }, { "displays", displays } });
+        }
+        cout << json{ { "transport", ActiveTransport()->Name() }, { "adapters", out } }.dump(2) << endl;
+        return 0;
+    }
 
-    if (iNumberAdapters <= 0)
-    {
-        cerr << "No AMD display devices found!" << endl;
-        return;
+    if (adapters.empty()) {
+        cerr << "No display devices found!" << endl;
+        return 1;
+    }
+    for (const auto& a : adapters) {
+        cout << "Adapter Index: " << dec << a.adapterIdx << " Adapter Name: " << a.name << endl;
+        for (const auto& d : a.displays) {
+            cout << "\tDisplay Index : " << d.displayIdx << " Display Name : " << d.name;
+            if (d.id.Valid()) cout << " EDID : " << EdidIdentityString(d.id);
+            cout << endl;
+        }
+    }
+    return 0;
+}
+#pragma endregion
+
+#pragma region trace-dump command
+
+int vTraceDumpCommand(const string& path)
+{
+    vector<DdcTraceEntry> entries;
+    if (!ReadDdcTraceFile(path, entries)) {
+        cerr << "trace-dump: " << path << " is not a frame trace" << endl;
+        return 1;
+    }
+    if (entries.empty()) {
+        cout << "No frames recorded" << endl;
+        return 0;
     }
 
-    lpAdapterInfo = (LPAdapterInfo)malloc(sizeof(AdapterInfo) * iNumberAdapters);
-    memset(lpAdapterInfo, '\0', sizeof(AdapterInfo) * iNumberAdapters);
+    const unsigned long long t0 = entries.front().timeNs;
+    for (const auto& e : entries) {
+        const unsigned long long us = (e.timeNs - t0) / 1000;
+        cout << dec << setw(6) << us / 1000 << "." << setfill('0') << setw(3) << us % 1000 << setfill(' ')
+             << " ms  " << (e.dir == DdcTraceDir::tx ? "->" : "<-") << " " << e.adapterIdx << ":" << e.displayIdx
+             << "  rc " << setw(4) << e.rc << "  ";
+        for (unsigned char b : e.bytes) cout << hex << setw(2) << setfill('0') << (unsigned int)b << ' ' << setfill(' ');
+        if (e.fullLen > e.bytes.size()) cout << "... ";
+        cout << " " << DescribeDdcFrame(e) << endl;
+    }
+    cout << dec << entries.size() << " frames" << endl;
+    return 0;
+}
+#pragma endregion
 
-    // Get the AdapterInfo structure for all adapters in the system
-    adlprocs.ADL_Adapter_AdapterInfo_Get(lpAdapterInfo, sizeof(AdapterInfo) * iNumberAdapters);
+#pragma region stats command
 
-    // Repeat for all available adapters in the system
-    for (int i = 0; i < iNumberAdapters; i++) {
-        iAdapterIndex = lpAdapterInfo[i].iAdapterIndex;
-        ADL_Main_Memory_Free((void**)&lpAdlDisplayInfo);
+static void print_metrics(ostream& os, const DdcMetricsSnapshot& s)
+{
+    const auto ms = [](unsigned long long us) {
+        ostringstream o;
+        o << fixed << setprecision(1) << us / 1000.0;
+        return o.str();
+    };
 
-        ADL_Err = adlprocs.ADL_Display_DisplayInfo_Get(lpAdapterInfo[i].iAdapterIndex, &iNumberDisplays, &lpAdlDisplayInfo, 0);
+    os << left << setw(11) << "latency (ms)" << right << setw(8) << "count" << setw(9) << "p50" << setw(9) << "p90"
+       << setw(9) << "p99" << setw(9) << "max" << setw(9) << "mean" << endl;
+    for (int m = 0; m < (int)DdcMetric::count; ++m) {
+        const DdcHistogramSnapshot& h = s.latency[m];
+        os << left << setw(12) << DdcMetricName((DdcMetric)m) << right << dec << setw(7) << h.count
+           << setw(9) << ms(h.PercentileUs(0.50)) << setw(9) << ms(h.PercentileUs(0.90))
+           << setw(9) << ms(h.PercentileUs(0.99)) << setw(9) << ms(h.maxUs) << setw(9) << ms(h.MeanUs()) << endl;
+    }
+    for (const auto& t : s.targets) {
+        os << "display " << t.adapterIdx << ":" << t.displayIdx << ":";
+        for (int c = 0; c < (int)DdcCounter::count; ++c)
+            os << " " << DdcCounterName((DdcCounter)c) << " " << t.counts[c];
+        os << endl;
+    }
+    if (!s.phasesMs.empty()) {
+        os << "phases:";
+        for (const auto& p : s.phasesMs)
+            os << " " << p.first << " " << dec << p.second << " ms";
+        os << endl;
+    }
+    if (!s.gauges.empty()) {
+        os << "gauges:";
+        for (const auto& g : s.gauges)
+            os << " " << g.first << " " << dec << g.second;
+        os << endl;
+    }
+}
 
-        cout << "Adapter Index: " << iAdapterIndex << " Adapter Name: " << lpAdapterInfo[i].strAdapterName << endl;
+int vStatsCommand(const string& path)
+{
+    ifstream f(path, ios::binary);
+    ostringstream text;
+    text << f.rdbuf();
+    DdcMetricsSnapshot s;
+    if (!f || !DdcMetricsFromJson(text.str(), s)) {
+        cerr << "stats: " << path << " is not a metrics dump" << endl;
+        return 1;
+    }
+    print_metrics(cout, s);
+    return 0;
+}
+#pragma endregion
 
-        for (int j = 0; j < iNumberDisplays; j++)
-        {
-            // For each display, check its status. Use the display only if it's connected AND mapped (iDisplayInfoValue: bit 0 and 1 )
-            if ((ADL_DISPLAY_DISPLAYINFO_DISPLAYCONNECTED | ADL_DISPLAY_DISPLAYINFO_DISPLAYMAPPED) !=
-                (ADL_DISPLAY_DISPLAYINFO_DISPLAYCONNECTED | ADL_DISPLAY_DISPLAYINFO_DISPLAYMAPPED & lpAdlDisplayInfo[j].iDisplayInfoValue))
-                continue;   // Skip the not connected or non-active displays
+#pragma region soak command
+// Monitor model a soak runs against unless --sim-model says otherwise: ~150 ms to show the
+// new input, a short re-sync, and the odd dropped acknowledgement or garbled reply
+#define SOAK_DEFAULT_MODEL "switch=150,jitter=50,busy=60,nak=0.005,corrupt=0.002"
+#define SOAK_ADAPTER 5                 // simulated displays are 0..N-1 on it, each its own bus
+#define SOAK_SETTLE_DEADLINE_MS 1000
 
-            // Is the display mapped to this adapter?
-            if ( iAdapterIndex != lpAdlDisplayInfo[ j ].displayID.iDisplayLogicalAdapterIndex )
-                continue;
+int vSoakCommand(unsigned int subaddress, unsigned int vcpCode, unsigned int switches, unsigned int displays)
+{
+    struct Tally {
+        unsigned int confirmed = 0, unconfirmed = 0, failed = 0;
+        unsigned int expected = 0;     // last value a write went through for
+    };
+    vector<Tally> tally(displays);
+    atomic<unsigned int> next{ 0 };
 
-            // Preserve the Connected displays in PDL style :-)
-            iDisplayIndex = lpAdlDisplayInfo[j].displayID.iDisplayLogicalIndex;
+    // One worker per display, each taking the next switch until the count is used up: the
+    // displays run in parallel like a group switch, each paced by its own bus
+    const auto started = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (unsigned int d = 0; d < displays; ++d) {
+        workers.emplace_back([&, d] {
+            unsigned int value = 0xD0;
+            while (next.fetch_add(1) < switches) {
+                value ^= 0x01;
+                const auto t0 = chrono::steady_clock::now();
+                DdcSwitchResult res{};
+                int rc = SetVcpFeatureWithI2cAddrEx(SOAK_ADAPTER, (int)d, (unsigned short)vcpCode, value, subaddress,
+                    SOAK_SETTLE_DEADLINE_MS, &res);
+                RecordDdcLatencyUs(DdcMetric::endToEnd,
+                    (uint64_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count());
+                if (rc != 0) { ++tally[d].failed; continue; }
+                tally[d].expected = value;
+                if (res.confirmed) ++tally[d].confirmed; else ++tally[d].unconfirmed;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
 
-            cout << "\tDisplay Index : " << iDisplayIndex << " Display Name : " << lpAdlDisplayInfo[j].strDisplayName << endl;
+    // Every display should end up on the last input a write went through for
+    this_thread::sleep_for(chrono::milliseconds(SOAK_SETTLE_DEADLINE_MS));
+    unsigned int confirmed = 0, unconfirmed = 0, failed = 0, wrongState = 0;
+    for (unsigned int d = 0; d < displays; ++d) {
+        confirmed += tally[d].confirmed;
+        unconfirmed += tally[d].unconfirmed;
+        failed += tally[d].failed;
+        if (!tally[d].expected) continue;
+        unsigned int cur = 0;
+        int rc = -1;
+        for (int attempt = 0; attempt < 5 && rc != 0; ++attempt)
+            rc = GetVcpFeatureWithI2cAddr(SOAK_ADAPTER, (int)d, (unsigned short)vcpCode, subaddress, &cur, nullptr);
+        if (rc != 0 || cur != tally[d].expected) {
+            ++wrongState;
+            cout << "display " << d << ": expected 0x" << hex << tally[d].expected << ", reads "
+                 << (rc == 0 ? "0x" : "error ") << (rc == 0 ? cur : (unsigned int)rc) << dec << endl;
         }
     }
+
+    const DdcMetricsSnapshot m = SnapshotDdcMetrics();
+    const DdcHistogramSnapshot& e2e = m.latency[(int)DdcMetric::endToEnd];
+    cout << dec << switches << " switches on " << displays << " simulated displays in " << fixed << setprecision(1)
+         << seconds << " s: " << switches / seconds << " switches/s" << endl;
+    cout << "confirmed " << confirmed << ", unconfirmed " << unconfirmed << ", failed " << failed
+         << "; switch p99.9 " << e2e.PercentileUs(0.999) / 1000.0 << " ms" << endl;
+    cout << (displays - wrongState) << "/" << displays << " displays on the last input written" << endl;
+    print_metrics(cout, m);
+    return wrongState ? 1 : 0;
 }
 #pragma endregion
 
-int main(int argc, const char* argv[])
+#pragma region serve command
+
+// Ctrl-C / kill stop the server through StopDdcServer, so RunDdcServer removes the socket
+// and closes the connections instead of leaving them to the next start's stale-socket probe
+#ifdef _WIN32
+static BOOL WINAPI serve_ctrl_handler(DWORD)
 {
-    if (!InitADL())
-        exit(1);
+    StopDdcServer(); // console handlers run on their own thread
+    return TRUE;
+}
+#endif
+
+// Answers requests until interrupted; main has already opened the transport
+int vServeCommand(string endpoint)
+{
+    if (endpoint.empty()) endpoint = DefaultDdcServerEndpoint();
+
+#ifdef _WIN32
+    SetConsoleCtrlHandler(serve_ctrl_handler, TRUE);
+#else
+    // StopDdcServer takes locks, so it can't run in a signal handler: block the signals here
+    // (threads started from now on inherit that) and take them on a thread of their own
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+    thread signalWaiter([stopSignals] {
+        int sig = 0;
+        sigwait(&stopSignals, &sig);
+        StopDdcServer();
+    });
+#endif
 
+    cout << "Serving on " << endpoint << " over the " << ActiveTransport()->Name() << " transport" << endl;
+    string err;
+    const bool served = RunDdcServer(endpoint, &err);
+
+#ifdef _WIN32
+    SetConsoleCtrlHandler(serve_ctrl_handler, FALSE);
+#else
+    if (!served) pthread_kill(signalWaiter.native_handle(), SIGTERM); // no signal came; release the waiter
+    signalWaiter.join();
+    pthread_sigmask(SIG_UNBLOCK, &stopSignals, nullptr);
+#endif
+
+    if (!served) {
+        cerr << "serve: " << err << endl;
+        return 1;
+    }
+    cout << "Stopped serving on " << endpoint << endl;
+    return 0;
+}
+
+// setvcp / getvcp / stats on a serve daemon. The connection is kept for the whole process,
+// so a batch pays for it once.
+int vRemoteCommand(const Settings& settings)
+{
+    static DdcServerClient client;
+    string err;
+    if (!client.Connected() && !client.Connect(settings.connect, &err)) {
+        cerr << "Error: " << err << endl;
+        return 1;
+    }
+
+    DdcServerRequest req{};
+    req.vcpCode = (uint8_t)settings.vcp_code;
+    req.i2cSubaddress = (uint8_t)settings.i2c_subaddress;
+    req.adapterIdx = (int16_t)settings.monitor;
+    req.displayIdx = (int16_t)settings.display;
+    req.value = settings.input;
+    switch (settings.command) {
+    case setvcp:
+        req.op = (uint8_t)(settings.wait_ms < 0 ? DdcServerOp::switchInput : DdcServerOp::setValue);
+        req.deadlineMs = SETVCP_SETTLE_DEADLINE_MS;
+        break;
+    case getvcp:
+        req.op = (uint8_t)DdcServerOp::getValue;
+        break;
+    case stats:
+        req.op = (uint8_t)DdcServerOp::stats;
+        break;
+    default:
+        cerr << "Error: --connect works with setvcp, getvcp and stats" << endl;
+        return 1;
+    }
+
+    DdcServerReply reply;
+    string text;
+    if (!client.Call(req, reply, &text)) {
+        cerr << "Error: lost the connection to " << settings.connect << endl;
+        return 1;
+    }
+    if (reply.rc != 0) {
+        cerr << command_to_string.at(settings.command) << " failed: " << dec << reply.rc << endl;
+        return 1;
+    }
+
+    switch (settings.command) {
+    case setvcp:
+        if (settings.wait_ms >= 0) {
+            if (settings.wait_ms > 0)
+                this_thread::sleep_for(chrono::milliseconds(settings.wait_ms));
+            print_unverified_write(settings.wait_ms);
+        }
+        else {
+            DdcSwitchResult res{};
+            res.confirmed = (reply.flags & DDC_SERVER_CONFIRMED) != 0;
+            res.alreadyActive = (reply.flags & DDC_SERVER_ALREADY_ACTIVE) != 0;
+            res.latencyMs = reply.latencyMs;
+            res.polls = reply.polls;
+            res.attempts = reply.attempts;
+            print_switch_result(settings.vcp_code, res);
+        }
+        break;
+    case getvcp:
+        cout << "VCP 0x" << hex << settings.vcp_code << ": current 0x" << reply.cur << ", max 0x" << reply.max << endl;
+        break;
+    default: {
+        DdcMetricsSnapshot s;
+        if (!DdcMetricsFromJson(text, s)) {
+            cerr << "stats: the server sent no metrics" << endl;
+            return 1;
+        }
+        print_metrics(cout, s);
+    }
+    }
+    return 0;
+}
+#pragma endregion
+
+#pragma region batch command
+
+// Commands a batch line may run: the ones that talk to a display over the session's
+// transport, or with --connect the ones the daemon answers (vRemoteCommand)
+static bool batch_allows(Command c, bool remote)
+{
+    if (remote) return c == setvcp || c == getvcp || c == stats;
+    return c == detect || c == setvcp || c == getvcp || c == caps;
+}
+
+static int run_command(const Settings& settings);
+
+// Splits a batch line on whitespace; # starts a comment
+static vector<string> batch_tokens(const string& line)
+{
+    istringstream in(line.substr(0, line.find('#')));
+    vector<string> tokens;
+    string t;
+    while (in >> t) tokens.push_back(t);
+    return tokens;
+}
+
+// Runs every line of a script over the transport main opened, instead of one process (and
+// one ADL init) per operation. A failing line is reported and the batch goes on; the exit
+// code says whether any failed.
+int vBatchCommand(const Settings& outer)
+{
+    ifstream file;
+    if (outer.batch_file != "-") {
+        file.open(outer.batch_file);
+        if (!file) {
+            cerr << "Error: could not open " << outer.batch_file << endl;
+            return 1;
+        }
+    }
+    istream& in = outer.batch_file == "-" ? cin : file;
+
+    // Lines start from the outer options, minus the batch itself
+    Settings defaults = outer;
+    defaults.command = unknown;
+    defaults.batch_file.clear();
+
+    const auto start = chrono::steady_clock::now();
+    unsigned int ops = 0, failed = 0, lineNo = 0;
+    string line;
+    while (getline(in, line)) {
+        ++lineNo;
+        const vector<string> tokens = batch_tokens(line);
+        if (tokens.empty()) continue;
+        ++ops;
+
+        vector<const char*> argv{ "amdddc-windows" };
+        for (const auto& t : tokens) argv.push_back(t.c_str());
+
+        Settings op;
+        string error;
+        try {
+            op = parse_settings((int)argv.size(), argv.data(), defaults);
+            if (!batch_allows(op.command, !op.connect.empty()))
+                error = op.connect.empty() ? "batch lines take detect, setvcp, getvcp or caps"
+                                           : "batch lines with --connect take setvcp, getvcp or stats";
+        }
+        catch (const exception& e) {
+            error = e.what();
+        }
+        if (!error.empty()) {
+            cerr << "line " << dec << lineNo << ": " << error << endl;
+            cout << "op\t" << dec << lineNo << "\t" << tokens[0] << "\tfailed\t0.0 ms" << endl;
+            ++failed;
+            continue;
+        }
+
+        const auto t0 = chrono::steady_clock::now();
+        const int rc = run_command(op);
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        if (rc != 0) ++failed;
+        cout << "op\t" << dec << lineNo << "\t" << command_to_string.at(op.command) << "\t"
+             << (rc == 0 ? "ok" : "failed") << "\t" << fixed << setprecision(1) << ms << " ms" << endl;
+        cout.unsetf(ios::fixed);
+    }
+
+    const double total = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "batch: " << dec << ops << " operations, " << failed << " failed, "
+         << fixed << setprecision(1) << total << " ms" << endl;
+    cout.unsetf(ios::fixed);
+    return failed ? 1 : 0;
+}
+#pragma endregion
+
+static void print_mock_stats() {
+    cerr << "ADL mock calls:" << endl;
+    for (const auto& kv : GetAdlMockStats()) {
+        cerr << "  " << kv.first << ": " << dec << kv.second.calls << " calls, "
+             << kv.second.failures << " failed, " << kv.second.latencyUs / 1000 << " ms injected" << endl;
+    }
+}
+
+// Dispatches one parsed command; the transport (or ADL, for detect) is already up
+static int run_command(const Settings& settings)
+{
+    // With --connect the daemon does the work; a batch forwards line by line
+    if (!settings.connect.empty() && settings.command != batch)
+        return vRemoteCommand(settings);
+
+    int rc = 0;
+    switch (settings.command) {
+    case detect:
+        rc = print_devices(settings.json);
+        break;
+    case setvcp:
+        rc = vSetVcpCommand(settings.i2c_subaddress, settings.vcp_code, settings.input, settings.monitor, settings.display,
+            settings.wait_ms);
+        break;
+    case getvcp:
+        rc = vGetVcpCommand(settings.i2c_subaddress, settings.vcp_code, settings.monitor, settings.display);
+        break;
+    case caps:
+        rc = vCapsCommand(settings.i2c_subaddress, settings.caps_cache, settings.monitor, settings.display);
+        break;
+    case soak:
+        rc = vSoakCommand(settings.i2c_subaddress, settings.vcp_code, settings.soak_switches, settings.soak_displays);
+        break;
+    case batch:
+        rc = vBatchCommand(settings);
+        break;
+    case serve:
+        rc = vServeCommand(settings.serve_endpoint);
+        break;
+    default:
+        print_help();
+    }
+    return rc;
+}
+
+int main(int argc, const char* argv[])
+{
     Settings settings;
 
     try {
@@ -137,14 +608,74 @@ int main(int argc, const char* argv[])
         return 0;
     }
 
-    switch (settings.command) {
-    case detect:
-        print_devices();
-        break;
-    case setvcp:
-        vSetVcpCommand(settings.i2c_subaddress, VCP_CODE_SWITCH_INPUT, settings.input, settings.monitor, settings.display);
-        break;
-    default:
-        print_help();
+    // Decoding a trace or a metrics dump talks to no display
+    if (settings.command == trace_dump)
+        return vTraceDumpCommand(settings.trace_file);
+    if (settings.command == stats && settings.connect.empty()) {
+        if (settings.metrics_file.empty()) {
+            cerr << "Error: stats needs a metrics file, or --connect to ask a serve daemon" << endl;
+            return 1;
+        }
+        return vStatsCommand(settings.metrics_file);
+    }
+
+    // The daemon owns the transport; this process only talks to it
+    if (!settings.connect.empty())
+        return run_command(settings);
+
+    if (!settings.trace_file.empty() && !OpenDdcTraceFile(settings.trace_file))
+        cerr << "Warning: could not open trace file " << settings.trace_file << "; tracing in memory only" << endl;
+
+    if (!settings.adl_mock.empty()) {
+        AdlMockConfig mock;
+        string err;
+        if (!LoadAdlMockScript(settings.adl_mock, mock, &err)) {
+            cerr << "Error: ADL mock script: " << err << endl;
+            return 1;
+        }
+        InstallAdlMock(mock);
+        if (settings.transport.empty()) settings.transport = "adl";
+    }
+
+    // soak always runs on simulated monitors; --sim-model also shapes --transport sim
+    if (settings.command == soak || settings.transport == "sim") {
+        SimTransportOptions opts;
+        string err;
+        if (settings.command == soak) {
+            ParseSimMonitorModel(SOAK_DEFAULT_MODEL, opts.model);
+            opts.displays.clear();
+            for (unsigned int d = 0; d < settings.soak_displays; ++d) opts.displays.push_back({ SOAK_ADAPTER, (int)d });
+        }
+        if (!settings.sim_model.empty() && !ParseSimMonitorModel(settings.sim_model, opts.model, &err)) {
+            cerr << "Error: --sim-model: " << err << endl;
+            return 1;
+        }
+        SetActiveTransport(CreateSimTransport(opts));
+    }
+    else if (!settings.transport.empty()) {
+        auto transport = CreateTransport(settings.transport);
+        if (!transport) {
+            cerr << "Error: transport '" << settings.transport << "' is not available on this platform" << endl;
+            return 1;
+        }
+        SetActiveTransport(move(transport));
+    }
+
+    if (!ActiveTransport()->Open())
+        exit(1);
+
+    const int rc = run_command(settings);
+
+    if (settings.verbose) {
+        const DdcBusStats bus = GetDdcBusStats();
+        cerr << "DDC bus: " << dec << bus.transactions << " transactions, " << bus.gapWaits
+             << " waited " << bus.gapWaitMs << " ms for the gap, " << bus.contended << " contended" << endl;
     }
+    if (settings.verbose && AdlMockInstalled())
+        print_mock_stats();
+    if (settings.verbose)
+        print_metrics(cerr, SnapshotDdcMetrics());
+    if (!settings.metrics_file.empty() && !WriteDdcMetricsFile(settings.metrics_file))
+        cerr << "Warning: could not write metrics to " << settings.metrics_file << endl;
+    return rc;
 }
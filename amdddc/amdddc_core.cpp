@@ -1,85 +1,228 @@
 #include "amdddc_core.h"
-#include "adl.h"
-#include <windows.h>
-#include <cstring>
+#include "ddc_bus.h"
+#include "ddc_frame.h"
+#include "ddc_latency.h"
+#include "ddc_metrics.h"
+#include "ddc_reply.h"
+#include "ddc_retry.h"
+#include "ddc_settle.h"
+#include "ddc_transport.h"
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
 
-// ==== Copied & adapted from your amdddc-windows.cpp ====
+// Input select: 0xF4 on the LG side channel (the original program's code), 0x60 per MCCS
+static const unsigned char VCP_CODE_SWITCH_INPUT = 0xF4;
+static const unsigned char VCP_CODE_INPUT_SELECT = 0x60;
 
-#define SETWRITESIZE 8
-#define SET_VCPCODE_SUBADDRESS 1
-#define SET_VCPCODE_OFFSET     4
-#define SET_HIGH_OFFSET        5
-#define SET_LOW_OFFSET         6
-#define SET_CHK_OFFSET         7
+static bool IsInputCode(unsigned char code)
+{
+    return code == VCP_CODE_SWITCH_INPUT || code == VCP_CODE_INPUT_SELECT;
+}
 
-// Side-channel code used by the original program for input switching
-static const unsigned char VCP_CODE_SWITCH_INPUT = 0xF4;
+// Upper bound on the settle wait; the monitor is polled and usually confirms much sooner
+static const unsigned int DEFAULT_SETTLE_DEADLINE_MS = 700;
+
+// A monitor that reads back another value after the settle gets the write once more
+static const int MAX_MISMATCH_REWRITES = 1;
 
-// Template message (DDC/CI spec)
-static unsigned char ucSetCommandWrite[SETWRITESIZE] = { 0x6e,0x51,0x84,0x03,0x00,0x00,0x00,0x00 };
+// Displays that answered "unsupported VCP code" when we read back the code we wrote.
+// They get no pre-check and no polling, just the fixed settle wait.
+static std::mutex g_noReadbackLock;
+static std::set<std::tuple<int, int, unsigned int, unsigned char>> g_noReadback; // {adapter, display, subaddress, code}
 
-// Ensure ADL is initialized exactly once for this process
-static bool EnsureADL()
+static bool ReadbackSupported(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char code)
 {
-    static bool inited = false;
-    if (inited) return true;
-    if (!InitADL()) return false;
-    inited = true;
-    return true;
+    std::lock_guard<std::mutex> lock(g_noReadbackLock);
+    return !g_noReadback.count(std::make_tuple(adapterIdx, displayIdx, subaddress, code));
 }
 
-// Local helper: raw I2C write via ADL
-static int vWriteI2c(char* lpucSendMsgBuf, int iSendMsgLen, int iAdapterIndex, int iDisplayIndex)
+static void MarkNoReadback(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char code)
 {
-    int iRev = 0;
-    // int ADL_Display_DDCBlockAccess_Get(int adapter, int display, int iOffset, int iCommand,
-    //                                    int iDataSize, char* lpData, int* lpRead, char* lpReadBuffer);
-    return adlprocs.ADL_Display_DDCBlockAccess_Get(
-        iAdapterIndex,
-        iDisplayIndex,
-        0,                // iOffset (was nullptr)
-        0,                // iCommand (was nullptr)
-        iSendMsgLen,
-        lpucSendMsgBuf,
-        &iRev,
-        (char*)0          // lpReadBuffer (was nullptr)
-    );
+    std::lock_guard<std::mutex> lock(g_noReadbackLock);
+    g_noReadback.insert(std::make_tuple(adapterIdx, displayIdx, subaddress, code));
 }
 
-// Local helper: builds the payload and writes it
-static int vSetVcpCommand(unsigned int subaddress, unsigned char ucVcp, unsigned int ulVal,
-    int iAdapterIndex, int iDisplayIndex)
+// Ensure the active transport (ADL by default) is ready; the backend opens only once, and
+// a prewarm started at tray startup is waited for instead of raced
+static bool EnsureTransport()
 {
-    // Build message per your original code/comments
-    ucSetCommandWrite[SET_VCPCODE_SUBADDRESS] = (unsigned char)subaddress; // e.g., 0x50
-    ucSetCommandWrite[SET_VCPCODE_OFFSET] = ucVcp;                      // 0xF4
-    ucSetCommandWrite[SET_LOW_OFFSET] = (unsigned char)(ulVal & 0xFF);       // e.g., 0xD1
-    ucSetCommandWrite[SET_HIGH_OFFSET] = (unsigned char)((ulVal >> 8) & 0xFF); // usually 0x00
-
-    // XOR checksum across bytes 0..6
-    unsigned char chk = 0;
-    for (int i = 0; i < SET_CHK_OFFSET; ++i) chk ^= ucSetCommandWrite[i];
-    ucSetCommandWrite[SET_CHK_OFFSET] = chk;
-
-    // Send
-    int rc = vWriteI2c((char*)ucSetCommandWrite, SETWRITESIZE, iAdapterIndex, iDisplayIndex);
+    return OpenActiveTransport();
+}
 
-    // Give the monitor a moment to switch / settle
-    Sleep(700);
+// Local helper: raw I2C write via the active transport, paced by the bus scheduler
+static int vWriteI2c(const unsigned char* lpucSendMsgBuf, int iSendMsgLen, int iAdapterIndex, int iDisplayIndex)
+{
+    return DdcBusWrite(iAdapterIndex, iDisplayIndex, lpucSendMsgBuf, iSendMsgLen);
+}
 
-    return rc;
+// Local helper: builds the payload on the stack and writes it (see ddc_frame.h for the layout)
+static int vSetVcpCommand(unsigned int subaddress, unsigned char ucVcp, unsigned int ulVal,
+    int iAdapterIndex, int iDisplayIndex)
+{
+    /*
+    * Display codes on the LG side channel (0xF4 via subaddress 0x50):
+    * 0xD0 - DP1, 0xD1 - USB-C (DP-2 Alt), 0x90 - HDMI, 0x91 - HDMI2
+    */
+    const auto frame = MakeSetVcpFrame((unsigned char)subaddress, ucVcp, ulVal);
+    return vWriteI2c(frame.data(), frame.size(), iAdapterIndex, iDisplayIndex);
 }
 
 // Public bridge used by the tray app
 extern "C" int SetVcpFeatureWithI2cAddr(
     int adapterIdx,
     int displayIdx,
-    unsigned short /*vcpCode_ignored*/,
+    unsigned short vcpCode,
     unsigned int valueHex,
     unsigned int i2cSubaddress)
 {
-    if (!EnsureADL()) return 1;
+    return SetVcpFeatureWithI2cAddrEx(adapterIdx, displayIdx, vcpCode, valueHex, i2cSubaddress,
+        DEFAULT_SETTLE_DEADLINE_MS, nullptr);
+}
+
+extern "C" int SetVcpValueWithI2cAddr(
+    int adapterIdx,
+    int displayIdx,
+    unsigned short vcpCode,
+    unsigned int value,
+    unsigned int i2cSubaddress)
+{
+    if (!EnsureTransport()) return 1;
+
+    DdcRetryOutcome w = RunWithRetry(DdcRetryPolicy(), [&] {
+        return vSetVcpCommand(i2cSubaddress, (unsigned char)vcpCode, value, adapterIdx, displayIdx);
+    });
+    RecordDdcRetry(w);
+    CountDdcEvent(adapterIdx, displayIdx, w.rc == 0 ? DdcCounter::success : DdcCounter::failure);
+    if (w.attempts.size() > 1) CountDdcEvent(adapterIdx, displayIdx, DdcCounter::retry, (unsigned int)w.attempts.size() - 1);
+    return w.rc;
+}
+
+extern "C" int SetVcpFeatureWithI2cAddrEx(
+    int adapterIdx,
+    int displayIdx,
+    unsigned short vcpCode,
+    unsigned int valueHex,
+    unsigned int i2cSubaddress,
+    unsigned int settleDeadlineMs,
+    DdcSwitchResult* outResult)
+{
+    DdcSwitchResult res{};
+    if (!EnsureTransport()) {
+        res.rc = 1;
+        if (outResult) *outResult = res;
+        return 1;
+    }
+
+    const unsigned char code = (unsigned char)vcpCode;
+    const bool readback = ReadbackSupported(adapterIdx, displayIdx, i2cSubaddress, code);
+
+    // Already on the requested input? Then skip the write and the settle entirely.
+    if (readback) {
+        VcpReply cur;
+        int rc = GetVcpFeature(adapterIdx, displayIdx, i2cSubaddress, code, cur);
+        if (rc == 0 && cur.cur == (valueHex & 0xFFFF)) {
+            res.confirmed = 1;
+            res.alreadyActive = 1;
+            CountDdcEvent(adapterIdx, displayIdx, DdcCounter::success);
+            if (outResult) *outResult = res;
+            return 0;
+        }
+        if (rc == DDC_ERR_UNSUPPORTED_VCP) MarkNoReadback(adapterIdx, displayIdx, i2cSubaddress, code);
+        // The bus scheduler keeps the write the DDC/CI gap away from this read
+    }
+
+    // Transient NAKs / busy replies are retried within a small budget (ddc_retry.h)
+    const DdcRetryPolicy policy;
+    std::chrono::steady_clock::time_point firstWriteAt, writtenAt;
+    bool first = true;
+    unsigned int missedAtMs = 0;    // input code: deadline of the last wait that ran out
+    for (int rewrites = 0;; ++rewrites) {
+        DdcRetryOutcome w = RunWithRetry(policy, [&] {
+            int rc = vSetVcpCommand(i2cSubaddress, code, valueHex, adapterIdx, displayIdx);
+            // Stamped once the frame is out: the bus may have held it back for the gap
+            writtenAt = std::chrono::steady_clock::now();
+            if (first) firstWriteAt = writtenAt;
+            first = false;
+            return rc;
+        });
+        RecordDdcRetry(w);
+        if (w.attempts.size() > 1) CountDdcEvent(adapterIdx, displayIdx, DdcCounter::retry, (unsigned int)w.attempts.size() - 1);
+        res.attempts += (int)w.attempts.size();
+        res.rc = w.rc;
+        res.errorClass = (int)w.cls;
+        if (res.rc != 0) break;
+
+        // Give the monitor a moment to switch / settle, but only until it confirms. Input
+        // switches poll on this display's own learned latency (ddc_latency.h); other codes
+        // read back right after the gap.
+        DdcSettleResult settle;
+        if (ReadbackSupported(adapterIdx, displayIdx, i2cSubaddress, code)) {
+            DdcLatencyProfile profile;
+            if (IsInputCode(code)) GetLatencyProfile(adapterIdx, displayIdx, profile);
+            unsigned int deadlineMs = SettleDeadlineMs(profile, settleDeadlineMs);
+            settle = WaitForVcpValue(adapterIdx, displayIdx, i2cSubaddress,
+                code, valueHex, writtenAt, deadlineMs,
+                FirstPollDelayMs(profile, deadlineMs));
+            // The learned deadline is only a forecast: a slower than usual switch gets the
+            // rest of the configured one before the write counts as lost
+            if (!settle.confirmed && !settle.unsupported && deadlineMs < settleDeadlineMs) {
+                const int earlierPolls = settle.polls;
+                settle = WaitForVcpValue(adapterIdx, displayIdx, i2cSubaddress,
+                    code, valueHex, writtenAt, settleDeadlineMs, deadlineMs);
+                settle.polls += earlierPolls;
+                deadlineMs = settleDeadlineMs;
+            }
+            RecordDdcLatencyUs(DdcMetric::settle, (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - writtenAt).count());
+            if (settle.unsupported) MarkNoReadback(adapterIdx, displayIdx, i2cSubaddress, code);
+            else if (!settle.confirmed) missedAtMs = deadlineMs;
+        } else {
+            std::this_thread::sleep_until(writtenAt + std::chrono::milliseconds(settleDeadlineMs));
+            settle.elapsedMs = settleDeadlineMs;
+        }
+        res.confirmed = settle.confirmed ? 1 : 0;
+        res.latencyMs = settle.elapsedMs +
+            (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(writtenAt - firstWriteAt).count();
+        res.polls += settle.polls;
+
+        // Still reading back the old value: the write was lost or ignored
+        if (!res.confirmed && settle.lastRc == 0) {
+            res.errorClass = (int)DdcErrorClass::mismatch;
+            if (rewrites < MAX_MISMATCH_REWRITES) continue;
+        }
+        break;
+    }
+
+    // Learn from the first write: a confirmation after a rewrite (or none at all) only says
+    // the switch takes longer than the deadline, so that is recorded instead (censored)
+    if (IsInputCode(code)) {
+        if (missedAtMs) RecordSwitchLatency(adapterIdx, displayIdx, missedAtMs);
+        else if (res.confirmed) RecordSwitchLatency(adapterIdx, displayIdx, res.latencyMs);
+    }
+
+    const bool failed = res.rc != 0 || res.errorClass == (int)DdcErrorClass::mismatch;
+    CountDdcEvent(adapterIdx, displayIdx, failed ? DdcCounter::failure : DdcCounter::success);
+    if (outResult) *outResult = res;
+    return (res.rc == 0) ? 0 : res.rc;
+}
+
+extern "C" int GetVcpFeatureWithI2cAddr(
+    int adapterIdx,
+    int displayIdx,
+    unsigned short vcpCode,
+    unsigned int i2cSubaddress,
+    unsigned int* outCurrent,
+    unsigned int* outMax)
+{
+    if (!EnsureTransport()) return 1;
 
-    int rc = vSetVcpCommand(i2cSubaddress, VCP_CODE_SWITCH_INPUT, valueHex, adapterIdx, displayIdx);
-    return (rc == 0) ? 0 : rc;
+    VcpReply reply;
+    int rc = GetVcpFeature(adapterIdx, displayIdx, i2cSubaddress, (unsigned char)vcpCode, reply);
+    if (rc != 0) return rc;
+    if (outCurrent) *outCurrent = reply.cur;
+    if (outMax) *outMax = reply.max;
+    return 0;
 }
@@ -1,11 +1,57 @@
 #pragma once
 
+// Outcome of a switch, filled by SetVcpFeatureWithI2cAddrEx.
+typedef struct DdcSwitchResult {
+    int rc;                 // transport status of the write (0 = ADL_OK)
+    int confirmed;          // 1 if the monitor read back the new value before the deadline
+    unsigned int latencyMs; // write -> confirmed input (or -> deadline when unconfirmed)
+    int polls;              // Get VCP reads spent confirming
+    int alreadyActive;      // 1 if the monitor was already on the value, so nothing was written
+    int attempts;           // writes issued, including retries
+    int errorClass;         // DdcErrorClass (ddc_retry.h) of the failure; 3 = wrote but read back another value
+} DdcSwitchResult;
+
 // Call this from your tray app to switch inputs via the LG alt I2C path.
 // Returns 0 on success, non-zero on failure.
 extern "C" int SetVcpFeatureWithI2cAddr(
     int adapterIdx,
     int displayIdx,
-    unsigned short vcpCode,     // Ignored for LG input switching; must be 0xF4 per original code
+    unsigned short vcpCode,     // 0xF4 for the LG input side channel, 0x60 for the standard input, or any other code
     unsigned int valueHex,      // e.g., 0xD0 (DP), 0xD1 (USB-C), 0x90 (HDMI1), 0x91 (HDMI2)
     unsigned int i2cSubaddress  // 0x50 for LG "alt" path
 );
+
+// Same write, but returns as soon as the monitor reads the new value back (polled with
+// Get VCP Feature) or settleDeadlineMs passes. Only input codes (0x60 / 0xF4) feed the
+// learned switch latency (ddc_latency.h). outResult may be null.
+extern "C" int SetVcpFeatureWithI2cAddrEx(
+    int adapterIdx,
+    int displayIdx,
+    unsigned short vcpCode,
+    unsigned int valueHex,
+    unsigned int i2cSubaddress,
+    unsigned int settleDeadlineMs,
+    DdcSwitchResult* outResult
+);
+
+// Plain Set VCP Feature for continuous controls (brightness 0x10, contrast 0x12, volume 0x62):
+// the write with retries, no pre-read and no settle. Returns 0 or the last write's status.
+extern "C" int SetVcpValueWithI2cAddr(
+    int adapterIdx,
+    int displayIdx,
+    unsigned short vcpCode,
+    unsigned int value,
+    unsigned int i2cSubaddress
+);
+
+// Get VCP Feature read over the same path (0x01 request -> 0x02 reply).
+// Returns 0 on success, the transport's ADL error code, or a DDC_ERR_* code from ddc_reply.h
+// (bad checksum/length, unsupported code, busy). outMax may be null.
+extern "C" int GetVcpFeatureWithI2cAddr(
+    int adapterIdx,
+    int displayIdx,
+    unsigned short vcpCode,
+    unsigned int i2cSubaddress,
+    unsigned int* outCurrent,
+    unsigned int* outMax
+);
@@ -0,0 +1,155 @@
+#include "ddc_bus.h"
+#include "ddc_metrics.h"
+#include "ddc_trace.h"
+#include "ddc_transport.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+// Longest wait for another process to finish its transaction before reporting the bus busy
+static const unsigned long DDC_BUS_XPROC_TIMEOUT_MS = 2000;
+
+struct Bus {
+    std::mutex lock;
+    long long localLastEnd = 0;     // Clock ticks; 0 = no transaction yet
+    long long* lastEnd = &localLastEnd;
+#ifdef _WIN32
+    HANDLE xprocMutex = nullptr;
+    HANDLE section = nullptr;
+#endif
+};
+
+static std::mutex g_busesLock;
+static std::map<std::pair<int, int>, Bus> g_buses; // node-stable, so Bus& stays valid
+
+static std::mutex g_statsLock;
+static DdcBusStats g_stats;
+
+#ifdef _WIN32
+// Bus objects shared with any other LGInputSwitch process. MSVC's steady_clock is
+// QueryPerformanceCounter, which is system-wide, so the stored time means the same there.
+static void OpenSharedBus(Bus& bus, int adapterIdx, int displayIdx)
+{
+    const std::string base = "Local\\LGInputSwitch.DDC." + std::to_string(adapterIdx) + "." + std::to_string(displayIdx);
+    bus.xprocMutex = CreateMutexA(nullptr, FALSE, (base + ".lock").c_str());
+    bus.section = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+        sizeof(long long), (base + ".last").c_str());
+    if (!bus.section) return;
+    // A fresh section is zero-filled, which reads as "no transaction yet"
+    void* view = MapViewOfFile(bus.section, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(long long));
+    if (view) bus.lastEnd = (long long*)view;
+}
+#endif
+
+static Bus& GetBus(int adapterIdx, int displayIdx)
+{
+    std::lock_guard<std::mutex> lock(g_busesLock);
+    auto it = g_buses.find({ adapterIdx, displayIdx });
+    if (it != g_buses.end()) return it->second;
+
+    Bus& bus = g_buses[{ adapterIdx, displayIdx }];
+#ifdef _WIN32
+    OpenSharedBus(bus, adapterIdx, displayIdx);
+#endif
+    return bus;
+}
+
+// Runs one transaction on the bus once the gap after the previous one has passed
+template <typename Op>
+static int Transact(int adapterIdx, int displayIdx, Op op)
+{
+    Bus& bus = GetBus(adapterIdx, displayIdx);
+    bool contended = false;
+
+    std::unique_lock<std::mutex> lock(bus.lock, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        contended = true;
+        lock.lock();
+    }
+
+#ifdef _WIN32
+    bool xprocHeld = false;
+    if (bus.xprocMutex) {
+        DWORD w = WaitForSingleObject(bus.xprocMutex, 0);
+        if (w == WAIT_TIMEOUT) {
+            contended = true;
+            w = WaitForSingleObject(bus.xprocMutex, DDC_BUS_XPROC_TIMEOUT_MS);
+        }
+        // WAIT_ABANDONED: the other process died mid-transaction; the bus is ours now
+        if (w != WAIT_OBJECT_0 && w != WAIT_ABANDONED) {
+            std::lock_guard<std::mutex> s(g_statsLock);
+            ++g_stats.contended;
+            return ADL_ERR_RESOURCE_CONFLICT;
+        }
+        xprocHeld = true;
+    }
+#endif
+
+    unsigned int waitedMs = 0;
+    if (*bus.lastEnd) {
+        const Clock::time_point ready = Clock::time_point(Clock::duration(*bus.lastEnd)) +
+            std::chrono::milliseconds(DDC_WRITE_GAP_MS);
+        const Clock::time_point now = Clock::now();
+        if (ready > now) {
+            waitedMs = (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(ready - now).count();
+            std::this_thread::sleep_until(ready);
+        }
+    }
+
+    const Clock::time_point began = Clock::now();
+    int rc = op();
+    const Clock::time_point ended = Clock::now();
+    *bus.lastEnd = ended.time_since_epoch().count();
+    RecordDdcLatencyUs(DdcMetric::adlCall,
+        (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(ended - began).count());
+
+#ifdef _WIN32
+    if (xprocHeld) ReleaseMutex(bus.xprocMutex);
+#endif
+
+    std::lock_guard<std::mutex> s(g_statsLock);
+    ++g_stats.transactions;
+    if (waitedMs) {
+        ++g_stats.gapWaits;
+        g_stats.gapWaitMs += waitedMs;
+    }
+    if (contended) ++g_stats.contended;
+    return rc;
+}
+
+int DdcBusWrite(int adapterIdx, int displayIdx, const unsigned char* frame, int len)
+{
+    return Transact(adapterIdx, displayIdx, [&] {
+        const std::uint64_t sentNs = DdcTraceNowNs();
+        int rc = ActiveTransport()->Write(adapterIdx, displayIdx, frame, len);
+        DdcTraceFrame(adapterIdx, displayIdx, DdcTraceDir::tx, frame, len, rc, sentNs);
+        return rc;
+    });
+}
+
+int DdcBusWriteRead(int adapterIdx, int displayIdx, const unsigned char* request, int requestLen,
+    unsigned char* reply, int* ioReplyLen)
+{
+    return Transact(adapterIdx, displayIdx, [&] {
+        const std::uint64_t sentNs = DdcTraceNowNs();
+        int rc = ActiveTransport()->WriteRead(adapterIdx, displayIdx, request, requestLen, reply, ioReplyLen);
+        DdcTraceFrame(adapterIdx, displayIdx, DdcTraceDir::tx, request, requestLen, rc, sentNs);
+        DdcTraceFrame(adapterIdx, displayIdx, DdcTraceDir::rx, reply, (rc == 0 && ioReplyLen) ? *ioReplyLen : 0, rc);
+        return rc;
+    });
+}
+
+DdcBusStats GetDdcBusStats()
+{
+    std::lock_guard<std::mutex> lock(g_statsLock);
+    return g_stats;
+}
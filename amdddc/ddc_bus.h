@@ -0,0 +1,30 @@
+#pragma once
+#ifndef DDC_BUS_H
+#define DDC_BUS_H
+
+// Per-bus DDC/CI message scheduling.
+//
+// Every DDC/CI message on a bus goes through here. The time the last transaction on each
+// {adapter, display} ended is kept, and the next one only waits what is left of the
+// DDC_WRITE_GAP_MS gap, rather than sleeping the full gap after every call. Transactions
+// on the same bus are serialized; different buses don't wait on each other.
+//
+// On Windows the gap is also kept across processes: a named mutex per bus serializes the
+// CLI and the tray, and the last-transaction time lives in a small named shared section.
+
+// Same contract as DdcTransport::Write / WriteRead on the active transport. Every frame
+// sent and received is also recorded in the trace ring (ddc_trace.h).
+int DdcBusWrite(int adapterIdx, int displayIdx, const unsigned char* frame, int len);
+int DdcBusWriteRead(int adapterIdx, int displayIdx, const unsigned char* request, int requestLen,
+    unsigned char* reply, int* ioReplyLen);
+
+struct DdcBusStats {
+    unsigned long long transactions = 0;
+    unsigned long long gapWaits = 0;       // transactions that had to wait for the gap
+    unsigned long long gapWaitMs = 0;      // total time spent waiting for it
+    unsigned long long contended = 0;      // bus was in use by another thread or process
+};
+
+DdcBusStats GetDdcBusStats();
+
+#endif // !DDC_BUS_H
@@ -0,0 +1,251 @@
+#include "ddc_caps.h"
+#include "ddc_bus.h"
+#include "ddc_edid.h"
+#include "ddc_frame.h"
+#include "ddc_metrics.h"
+#include "ddc_reply.h"
+#include "ddc_transport.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include "../external/json.hpp"
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+// ---------- Fetch ----------
+
+// One fragment round trip. Returns 0 with the data bytes appended to out, or an error.
+static int ReadFragment(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned int offset,
+    std::string& out, int& dataLen)
+{
+    const auto req = MakeCapabilitiesFrame((unsigned char)subaddress, offset);
+
+    // 0x6E, length, 0xE3, offset hi/lo, up to 32 data bytes, checksum
+    unsigned char reply[DDC_CAPS_FRAGMENT_MAX + 8] = {};
+    int replyLen = (int)sizeof(reply);
+    int rc = DdcBusWriteRead(adapterIdx, displayIdx, req.data(), req.size(), reply, &replyLen);
+    if (rc != ADL_OK) return rc;
+
+    DdcReplyParser parser;
+    parser.Feed(reply, replyLen);
+    if (parser.state() == DdcReplyParser::State::error) {
+        CountDdcEvent(adapterIdx, displayIdx, DdcCounter::checksumError);
+        return DDC_ERR_CHECKSUM;
+    }
+    if (parser.state() != DdcReplyParser::State::complete) return DDC_ERR_BAD_REPLY;
+    if (parser.IsNullMessage()) return DDC_ERR_NULL_REPLY;
+
+    const unsigned char* p = parser.Payload();
+    const int n = parser.PayloadLen() - 3;
+    if (n < 0 || n > DDC_CAPS_FRAGMENT_MAX || p[0] != 0xE3) return DDC_ERR_BAD_REPLY;
+    // A reply for another offset is a stale or repeated fragment; ask again
+    if ((unsigned int)((p[1] << 8) | p[2]) != offset) return DDC_ERR_BAD_REPLY;
+
+    out.append((const char*)p + 3, (std::size_t)n);
+    dataLen = n;
+    return 0;
+}
+
+int ReadCapabilitiesString(int adapterIdx, int displayIdx, unsigned int subaddress, std::string& out)
+{
+    out.clear();
+    std::string buf;
+    unsigned int offset = 0;
+
+    while (buf.size() < DDC_CAPS_MAX_LEN) {
+        int dataLen = 0;
+        int rc = -1;
+        for (int attempt = 0; attempt <= DDC_CAPS_FRAGMENT_RETRIES; ++attempt) {
+            // Fragments are paced by the bus scheduler (ddc_bus.h)
+            rc = ReadFragment(adapterIdx, displayIdx, subaddress, offset, buf, dataLen);
+            if (rc == 0) break;
+            // Unsupported / missing display won't get better by asking again
+            if (rc == ADL_ERR_INVALID_ADL_IDX || rc == ADL_ERR_NOT_SUPPORTED || rc == ADL_ERR_INVALID_PARAM) break;
+        }
+        if (rc != 0) return rc;
+        if (dataLen == 0) break;
+        offset += (unsigned int)dataLen;
+    }
+
+    // The string is plain ASCII; some displays also send the terminating NUL or padding
+    for (char c : buf)
+        if (c >= 0x20 && c < 0x7F) out.push_back(c);
+    return 0;
+}
+
+// ---------- Parse ----------
+
+static bool IsHex(char c) { return std::isxdigit((unsigned char)c) != 0; }
+
+static void SkipSpaces(const std::string& s, std::size_t& i)
+{
+    while (i < s.size() && std::isspace((unsigned char)s[i])) ++i;
+}
+
+// Index one past the ')' matching the '(' at open, or npos if unbalanced
+static std::size_t MatchParen(const std::string& s, std::size_t open)
+{
+    int depth = 0;
+    for (std::size_t i = open; i < s.size(); ++i) {
+        if (s[i] == '(') ++depth;
+        else if (s[i] == ')' && --depth == 0) return i + 1;
+    }
+    return std::string::npos;
+}
+
+// Value of a run of hex digits that is known to fit (callers check the length)
+static unsigned int HexValue(const std::string& s, std::size_t start, std::size_t end)
+{
+    unsigned int v = 0;
+    for (std::size_t i = start; i < end; ++i) {
+        const char c = (char)std::tolower((unsigned char)s[i]);
+        v = (v << 4) | (unsigned int)(c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+    return v;
+}
+
+// "10 12 60(0F 11 12) F4" -> codes with optional value lists. Runs of hex digits too long
+// to be a code (or a value) are garbage from the bus and skipped, with their value list.
+static void ParseVcpList(const std::string& s, std::map<unsigned char, std::vector<unsigned short>>& out)
+{
+    std::size_t i = 0;
+    while (i < s.size()) {
+        SkipSpaces(s, i);
+        if (i >= s.size()) break;
+        if (!IsHex(s[i])) { ++i; continue; }
+
+        std::size_t start = i;
+        while (i < s.size() && IsHex(s[i])) ++i;
+        std::vector<unsigned short>* values = i - start <= 2 ? &out[(unsigned char)HexValue(s, start, i)] : nullptr;
+
+        SkipSpaces(s, i);
+        if (i < s.size() && s[i] == '(') {
+            const std::size_t end = MatchParen(s, i);
+            const std::size_t stop = end == std::string::npos ? s.size() : end - 1;
+            for (std::size_t j = i + 1; j < stop;) {
+                if (!IsHex(s[j])) { ++j; continue; }
+                std::size_t vs = j;
+                while (j < stop && IsHex(s[j])) ++j;
+                if (values && j - vs <= 4)
+                    values->push_back((unsigned short)HexValue(s, vs, j));
+            }
+            i = end == std::string::npos ? s.size() : end;
+        }
+    }
+}
+
+bool ParseCapabilities(const std::string& raw, DdcCapabilities& out)
+{
+    out = DdcCapabilities();
+    out.raw = raw;
+
+    // The whole string is normally wrapped in one pair of parentheses. Nothing a display
+    // sends is longer than DDC_CAPS_MAX_LEN; a longer one (e.g. a damaged cache) is cut there.
+    std::string s = raw.substr(0, DDC_CAPS_MAX_LEN);
+    const std::size_t first = s.find_first_not_of(" \t\r\n");
+    const std::size_t last = s.find_last_not_of(" \t\r\n");
+    if (first != std::string::npos && s[first] == '(' && MatchParen(s, first) == last + 1)
+        s = s.substr(first + 1, last - first - 1);
+
+    bool haveVcp = false;
+    std::size_t i = 0;
+    while (i < s.size()) {
+        SkipSpaces(s, i);
+        std::size_t kw = i;
+        while (i < s.size() && (std::isalnum((unsigned char)s[i]) || s[i] == '_')) ++i;
+        std::string key = s.substr(kw, i - kw);
+        for (char& c : key) c = (char)std::tolower((unsigned char)c);
+
+        SkipSpaces(s, i);
+        if (i >= s.size() || s[i] != '(') {
+            if (i == kw) ++i; // stray character
+            continue;
+        }
+        // Displays with a missing closing parenthesis are common; take the rest of the string
+        const std::size_t end = MatchParen(s, i);
+        const std::string value = end == std::string::npos ? s.substr(i + 1) : s.substr(i + 1, end - i - 2);
+        i = end == std::string::npos ? s.size() : end;
+
+        if (key == "type") out.type = value;
+        else if (key == "model") out.model = value;
+        else if (key == "mccs_ver") out.mccsVersion = value;
+        else if (key == "vcp") {
+            ParseVcpList(value, out.vcp);
+            haveVcp = true;
+        }
+    }
+    return haveVcp;
+}
+
+// ---------- Cache ----------
+
+// Cache file: { "<edid model hash>": { "model": "...", "raw": "(prot(monitor)...)" }, ... }
+static std::mutex g_cacheLock;
+
+static nlohmann::json LoadCache(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return nlohmann::json::object();
+    std::stringstream ss;
+    ss << f.rdbuf();
+    try {
+        nlohmann::json j = nlohmann::json::parse(ss.str());
+        if (j.is_object()) return j;
+    }
+    catch (...) {
+    }
+    return nlohmann::json::object();
+}
+
+static bool SaveCache(const std::string& path, const nlohmann::json& j)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    const std::string text = j.dump(2);
+    f.write(text.data(), (std::streamsize)text.size());
+    return (bool)f;
+}
+
+int GetCapabilities(int adapterIdx, int displayIdx, unsigned int subaddress,
+    const std::string& cachePath, DdcCapabilities& out, bool* fromCache)
+{
+    if (fromCache) *fromCache = false;
+
+    std::string key;
+    if (!cachePath.empty()) {
+        unsigned char edid[256] = {};
+        int edidLen = (int)sizeof(edid);
+        if (ActiveTransport()->ReadEdid(adapterIdx, displayIdx, edid, &edidLen) == ADL_OK) {
+            unsigned long long hash = EdidModelHash(edid, edidLen);
+            if (hash) key = EdidHashString(hash);
+        }
+    }
+
+    if (!key.empty()) {
+        std::lock_guard<std::mutex> lock(g_cacheLock);
+        nlohmann::json cache = LoadCache(cachePath);
+        auto it = cache.find(key);
+        if (it != cache.end() && it->is_object() && it->contains("raw") && (*it)["raw"].is_string()) {
+            if (ParseCapabilities((*it)["raw"].get<std::string>(), out)) {
+                if (fromCache) *fromCache = true;
+                return 0;
+            }
+        }
+    }
+
+    std::string raw;
+    int rc = ReadCapabilitiesString(adapterIdx, displayIdx, subaddress, raw);
+    if (rc != 0) return rc;
+    if (!ParseCapabilities(raw, out)) return DDC_ERR_BAD_REPLY;
+
+    if (!key.empty()) {
+        // Re-read under the lock so concurrent fetches for different models both land
+        std::lock_guard<std::mutex> lock(g_cacheLock);
+        nlohmann::json cache = LoadCache(cachePath);
+        cache[key] = { {"model", out.model}, {"raw", raw} };
+        SaveCache(cachePath, cache);
+    }
+    return 0;
+}
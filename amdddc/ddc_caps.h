@@ -0,0 +1,50 @@
+#pragma once
+#ifndef DDC_CAPS_H
+#define DDC_CAPS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// DDC/CI Capabilities Request (0xF3) / Capabilities Reply (0xE3).
+//
+// The string comes back in fragments of at most 32 bytes. Each request carries the
+// offset of the next byte wanted and each reply echoes it:
+//   request: 0x6E, sub, 0x83, 0xF3, offset hi, offset lo, checksum
+//   reply:   0x6E, 0x80 | (3 + n), 0xE3, offset hi, offset lo, n data bytes, checksum
+// A reply with no data bytes ends the string. Fetching a full string takes a few
+// seconds (one 50 ms spaced round trip per fragment), so results are cached on disk
+// per monitor model.
+
+#define DDC_CAPS_FRAGMENT_MAX     32    // data bytes per reply
+#define DDC_CAPS_MAX_LEN          4096  // stop runaway displays that never send the end fragment
+#define DDC_CAPS_FRAGMENT_RETRIES 3     // re-requests of one offset after a bad or busy reply
+
+// Parsed capabilities string, e.g.
+//   (prot(monitor)type(LCD)model(27GN950)cmds(01 02 03 0C E3 F3)vcp(10 12 60(0F 11 12) F4)mccs_ver(2.1))
+struct DdcCapabilities {
+    std::string raw;
+    std::string type;
+    std::string model;
+    std::string mccsVersion;
+    // VCP code -> listed values; empty for continuous codes or codes listed without values
+    std::map<unsigned char, std::vector<unsigned short>> vcp;
+
+    bool SupportsVcp(unsigned char code) const { return vcp.count(code) != 0; }
+};
+
+// Reads the full string from the display, reassembling fragments by offset.
+// Returns 0, an ADL error code from the transport, or a DDC_ERR_* code from ddc_reply.h.
+int ReadCapabilitiesString(int adapterIdx, int displayIdx, unsigned int subaddress, std::string& out);
+
+// Returns false if no vcp(...) section could be found.
+bool ParseCapabilities(const std::string& raw, DdcCapabilities& out);
+
+// Capabilities for the display, from the JSON cache at cachePath when a display with the
+// same EDID model hash has been read before; otherwise read live and added to the cache.
+// An empty cachePath, or a display whose EDID can't be read, always reads live.
+// fromCache may be null.
+int GetCapabilities(int adapterIdx, int displayIdx, unsigned int subaddress,
+    const std::string& cachePath, DdcCapabilities& out, bool* fromCache = nullptr);
+
+#endif // !DDC_CAPS_H
@@ -0,0 +1,173 @@
+#include "ddc_coalesce.h"
+#include "amdddc_core.h"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+struct Slot {
+    int adapterIdx = 0;
+    int displayIdx = 0;
+    unsigned int subaddress = 0;
+    unsigned char code = 0;
+
+    // Waiting update: an absolute value, or a sum of steps (relative)
+    bool pending = false;
+    bool relative = false;
+    long long value = 0;
+    long long delta = 0;
+
+    // Last value on the monitor, as far as we know
+    bool known = false;
+    unsigned int cur = 0;
+    unsigned int max = 0;    // 0 = not read yet
+
+    std::thread worker;
+};
+
+using SlotKey = std::tuple<int, int, unsigned int, unsigned char>;
+
+static std::mutex g_lock;
+static std::condition_variable g_cv;
+static bool g_stop = false;
+static std::map<SlotKey, std::unique_ptr<Slot>> g_slots;
+static DdcCoalesceStats g_stats;
+
+static unsigned int Clamp(long long v, unsigned int max)
+{
+    if (v < 0) return 0;
+    const long long hi = max ? max : 0xFFFF;
+    return (unsigned int)(v > hi ? hi : v);
+}
+
+static void WorkerMain(Slot* s)
+{
+    std::unique_lock<std::mutex> lock(g_lock);
+    for (;;) {
+        g_cv.wait(lock, [&] { return g_stop || s->pending; });
+        if (g_stop) return;
+
+        // Take the latest request; anything arriving from here on waits for the next round
+        const bool relative = s->relative;
+        const long long value = s->value, delta = s->delta;
+        s->pending = s->relative = false;
+        s->value = s->delta = 0;
+        bool known = s->known;
+        unsigned int cur = s->cur, max = s->max;
+        lock.unlock();
+
+        int rc = 0;
+        if (relative && !known) {
+            rc = GetVcpFeatureWithI2cAddr(s->adapterIdx, s->displayIdx, s->code, s->subaddress, &cur, &max);
+            known = rc == 0;
+        }
+        const unsigned int target = relative ? Clamp((long long)cur + delta, max) : Clamp(value, max);
+        if (rc == 0)
+            rc = SetVcpValueWithI2cAddr(s->adapterIdx, s->displayIdx, s->code, target, s->subaddress);
+
+        lock.lock();
+        if (rc == 0) {
+            s->known = true;
+            s->cur = target;
+            s->max = max;
+            ++g_stats.written;
+        } else {
+            if (known && !s->known) { s->known = true; s->cur = cur; s->max = max; }
+            ++g_stats.failed;
+        }
+    }
+}
+
+// Caller holds g_lock
+static Slot& GetSlot(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char code)
+{
+    auto& p = g_slots[std::make_tuple(adapterIdx, displayIdx, subaddress, code)];
+    if (!p) {
+        p = std::make_unique<Slot>();
+        p->adapterIdx = adapterIdx;
+        p->displayIdx = displayIdx;
+        p->subaddress = subaddress;
+        p->code = code;
+        p->worker = std::thread(WorkerMain, p.get());
+    }
+    return *p;
+}
+
+void SubmitVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    unsigned int value)
+{
+    std::lock_guard<std::mutex> lock(g_lock);
+    if (g_stop) return;
+    Slot& s = GetSlot(adapterIdx, displayIdx, subaddress, vcpCode);
+    ++g_stats.submitted;
+    if (s.pending) ++g_stats.coalesced;
+    s.pending = true;
+    s.relative = false;
+    s.value = value;
+    s.delta = 0;
+    g_cv.notify_all();
+}
+
+void SubmitVcpStep(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    int delta)
+{
+    std::lock_guard<std::mutex> lock(g_lock);
+    if (g_stop) return;
+    Slot& s = GetSlot(adapterIdx, displayIdx, subaddress, vcpCode);
+    ++g_stats.submitted;
+    if (s.pending) {
+        ++g_stats.coalesced;
+        // Onto a waiting absolute value it stays absolute; otherwise the steps add up
+        if (s.relative) s.delta += delta;
+        else s.value += delta;
+    } else {
+        s.pending = true;
+        s.relative = true;
+        s.delta = delta;
+    }
+    g_cv.notify_all();
+}
+
+bool GetCoalescedVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    unsigned int& outCurrent, unsigned int& outMax)
+{
+    std::lock_guard<std::mutex> lock(g_lock);
+    auto it = g_slots.find(std::make_tuple(adapterIdx, displayIdx, subaddress, vcpCode));
+    if (it == g_slots.end() || !it->second->known) return false;
+    outCurrent = it->second->cur;
+    outMax = it->second->max;
+    return true;
+}
+
+void NoteVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    unsigned int value)
+{
+    std::lock_guard<std::mutex> lock(g_lock);
+    auto it = g_slots.find(std::make_tuple(adapterIdx, displayIdx, subaddress, vcpCode));
+    if (it == g_slots.end()) return;
+    it->second->known = true;
+    it->second->cur = value;
+}
+
+void StopVcpCoalescer()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        g_stop = true;
+    }
+    g_cv.notify_all();
+    for (auto& kv : g_slots)
+        if (kv.second->worker.joinable()) kv.second->worker.join();
+
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_slots.clear();
+    g_stop = false;
+}
+
+DdcCoalesceStats GetVcpCoalesceStats()
+{
+    std::lock_guard<std::mutex> lock(g_lock);
+    return g_stats;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef DDC_COALESCE_H
+#define DDC_COALESCE_H
+
+// Latest-value writes for continuous VCP controls (brightness 0x10, contrast 0x12, volume 0x62).
+//
+// One slot per {adapter, display, subaddress, code}, each with its own writer thread. A
+// value submitted while the slot's write is in flight replaces whatever was still waiting,
+// so a held brightness key costs one write per bus gap instead of one per key repeat.
+// Submitting never blocks on DDC.
+
+// Absolute value, clamped to the monitor's maximum once that is known.
+void SubmitVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    unsigned int value);
+
+// Relative change. Steps that pile up while a write is in flight add up; the base is the
+// last value written, or the monitor's current value (read once) before the first write.
+void SubmitVcpStep(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    int delta);
+
+// Last value written (or read) and the monitor's maximum. False until the slot has either.
+bool GetCoalescedVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    unsigned int& outCurrent, unsigned int& outMax);
+
+// A value written some other way (e.g. a scene): later steps start from it. No-op for
+// a slot that doesn't exist yet.
+void NoteVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress, unsigned char vcpCode,
+    unsigned int value);
+
+// Finishes the writes in flight and drops anything still waiting.
+void StopVcpCoalescer();
+
+struct DdcCoalesceStats {
+    unsigned long long submitted = 0;
+    unsigned long long coalesced = 0;  // submissions merged into one still waiting
+    unsigned long long written = 0;
+    unsigned long long failed = 0;
+};
+
+DdcCoalesceStats GetVcpCoalesceStats();
+
+#endif // !DDC_COALESCE_H
@@ -0,0 +1,127 @@
+#include "ddc_edid.h"
+#include <cstdio>
+
+bool EdidValid(const unsigned char* edid, int len)
+{
+    static const unsigned char header[8] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+    if (!edid || len < EDID_BLOCK_SIZE) return false;
+    for (int i = 0; i < 8; ++i)
+        if (edid[i] != header[i]) return false;
+
+    unsigned char sum = 0;
+    for (int i = 0; i < EDID_BLOCK_SIZE; ++i) sum = (unsigned char)(sum + edid[i]);
+    return sum == 0;
+}
+
+// Bytes that differ between two units of the same model
+static bool IsPerUnitByte(const unsigned char* edid, int i)
+{
+    if (i >= 12 && i <= 17) return true;   // serial number, week / year
+    if (i == EDID_BLOCK_SIZE - 1) return true;  // checksum follows the above
+    for (int d = 54; d <= 108; d += 18) {
+        const bool serialText = edid[d] == 0 && edid[d + 1] == 0 && edid[d + 3] == 0xFF;
+        if (serialText && i >= d && i < d + 18) return true;
+    }
+    return false;
+}
+
+unsigned long long EdidModelHash(const unsigned char* edid, int len)
+{
+    if (!EdidValid(edid, len)) return 0;
+
+    unsigned long long h = 14695981039346656037ull;
+    for (int i = 0; i < EDID_BLOCK_SIZE; ++i) {
+        h ^= IsPerUnitByte(edid, i) ? 0u : edid[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool ParseEdidIdentity(const unsigned char* edid, int len, EdidIdentity& out)
+{
+    out = EdidIdentity();
+    if (!EdidValid(edid, len)) return false;
+
+    // Manufacturer: big endian, bit 15 reserved, then three 5-bit letters ('A' = 1)
+    const unsigned int m = ((unsigned int)edid[8] << 8) | edid[9];
+    const unsigned int letters[3] = { (m >> 10) & 0x1F, (m >> 5) & 0x1F, m & 0x1F };
+    for (unsigned int l : letters) {
+        if (l < 1 || l > 26) return false;
+        out.manufacturer.push_back((char)('A' + l - 1));
+    }
+
+    out.product = (unsigned short)(edid[10] | (edid[11] << 8));
+    out.serial = (unsigned int)edid[12] | ((unsigned int)edid[13] << 8) |
+        ((unsigned int)edid[14] << 16) | ((unsigned int)edid[15] << 24);
+
+    for (int d = 54; d <= 108; d += 18) {
+        if (edid[d] != 0 || edid[d + 1] != 0 || edid[d + 3] != 0xFF) continue;
+        // Up to 13 characters, terminated by 0x0A and padded with spaces
+        for (int i = d + 5; i < d + 18 && edid[i] != 0x0A; ++i)
+            if (edid[i] >= 0x20 && edid[i] < 0x7F) out.serialText.push_back((char)edid[i]);
+        while (!out.serialText.empty() && out.serialText.back() == ' ') out.serialText.pop_back();
+        break;
+    }
+    return true;
+}
+
+// 18-byte display descriptor: 00 00 00 tag 00, then 13 characters ended by 0x0A, space padded
+static void WriteTextDescriptor(unsigned char* d, unsigned char tag, const std::string& text)
+{
+    d[3] = tag;
+    size_t i = 0;
+    for (; i < text.size() && i < 13; ++i) d[5 + i] = (unsigned char)text[i];
+    if (i < 13) d[5 + i++] = 0x0A;
+    for (; i < 13; ++i) d[5 + i] = ' ';
+}
+
+void BuildEdidBlock(const EdidIdentity& id, const std::string& name, unsigned char (&out)[EDID_BLOCK_SIZE])
+{
+    for (auto& b : out) b = 0;
+    out[0] = 0x00;
+    for (int i = 1; i < 7; ++i) out[i] = 0xFF;
+    out[7] = 0x00;
+
+    unsigned int m = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        char c = i < id.manufacturer.size() ? id.manufacturer[i] : 'A';
+        m = (m << 5) | (unsigned int)((c >= 'A' && c <= 'Z') ? c - 'A' + 1 : 1);
+    }
+    out[8] = (unsigned char)(m >> 8);
+    out[9] = (unsigned char)(m & 0xFF);
+    out[10] = (unsigned char)(id.product & 0xFF);
+    out[11] = (unsigned char)(id.product >> 8);
+    out[12] = (unsigned char)id.serial;
+    out[13] = (unsigned char)(id.serial >> 8);
+    out[14] = (unsigned char)(id.serial >> 16);
+    out[15] = (unsigned char)(id.serial >> 24);
+    out[16] = 1;    // week
+    out[17] = 34;   // 1990 + 34
+    out[18] = 1;    // EDID 1.4
+    out[19] = 4;
+
+    WriteTextDescriptor(out + 54, 0xFC, name);
+    if (!id.serialText.empty()) WriteTextDescriptor(out + 72, 0xFF, id.serialText);
+
+    unsigned char sum = 0;
+    for (int i = 0; i < EDID_BLOCK_SIZE - 1; ++i) sum = (unsigned char)(sum + out[i]);
+    out[EDID_BLOCK_SIZE - 1] = (unsigned char)(0x100 - sum);
+}
+
+std::string EdidIdentityString(const EdidIdentity& id)
+{
+    if (!id.Valid()) return "(unknown)";
+    char buf[64];
+    if (!id.serialText.empty())
+        snprintf(buf, sizeof(buf), "%s %04X %s", id.manufacturer.c_str(), id.product, id.serialText.c_str());
+    else
+        snprintf(buf, sizeof(buf), "%s %04X #%u", id.manufacturer.c_str(), id.product, id.serial);
+    return buf;
+}
+
+std::string EdidHashString(unsigned long long hash)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", hash);
+    return buf;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef DDC_EDID_H
+#define DDC_EDID_H
+
+#include <string>
+
+// EDID base block (128 bytes) helpers.
+//
+//   0..7    - header 00 FF FF FF FF FF FF 00
+//   8..9    - manufacturer ID (three 5-bit letters, big endian)
+//   10..11  - product code (little endian)
+//   12..15  - serial number (little endian)
+//   16..17  - week / year of manufacture
+//   54..125 - four 18-byte descriptors (0xFF = serial text, 0xFC = name)
+//   127     - checksum: all 128 bytes sum to 0 mod 256
+
+#define EDID_BLOCK_SIZE 128
+
+// Who a display is, independent of where the driver currently enumerates it.
+// serialText comes from the 0xFF descriptor; many monitors leave the binary serial at 0
+// and only fill that in.
+struct EdidIdentity {
+    std::string manufacturer;   // three-letter PNP ID, e.g. "GSM" for LG
+    unsigned short product = 0;
+    unsigned int serial = 0;
+    std::string serialText;
+
+    bool Valid() const { return manufacturer.size() == 3; }
+    bool operator==(const EdidIdentity& o) const
+    {
+        return manufacturer == o.manufacturer && product == o.product && serial == o.serial && serialText == o.serialText;
+    }
+    bool operator!=(const EdidIdentity& o) const { return !(*this == o); }
+    bool operator<(const EdidIdentity& o) const
+    {
+        if (manufacturer != o.manufacturer) return manufacturer < o.manufacturer;
+        if (product != o.product) return product < o.product;
+        if (serial != o.serial) return serial < o.serial;
+        return serialText < o.serialText;
+    }
+};
+
+bool EdidValid(const unsigned char* edid, int len);
+
+// 64-bit FNV-1a over the base block with the per-unit fields (serial number, date of
+// manufacture, serial text descriptor, checksum) masked, so every unit of one monitor
+// model hashes the same. Returns 0 for an invalid block.
+unsigned long long EdidModelHash(const unsigned char* edid, int len);
+
+// Returns false (and leaves out invalid) for a block that fails EdidValid.
+bool ParseEdidIdentity(const unsigned char* edid, int len, EdidIdentity& out);
+
+// Synthesizes a valid base block for id with a display name descriptor (up to 13
+// characters) and, when id.serialText is set, a serial text descriptor. For simulated
+// displays.
+void BuildEdidBlock(const EdidIdentity& id, const std::string& name, unsigned char (&out)[EDID_BLOCK_SIZE]);
+
+// Short display form, e.g. "GSM 5BBF #123456" or "GSM 5BBF 204NTABC1234"
+std::string EdidIdentityString(const EdidIdentity& id);
+
+// Hash as 16 lowercase hex digits, e.g. for use as a cache key
+std::string EdidHashString(unsigned long long hash);
+
+#endif // !DDC_EDID_H
@@ -0,0 +1,99 @@
+#pragma once
+#ifndef DDC_FRAME_H
+#define DDC_FRAME_H
+
+#include <cstddef>
+
+// DDC/CI host->display frames, built by value on the caller's stack.
+//
+// Following DDC/CI Spec defined here: https://boichat.ch/nicolas/ddcci/specs.html
+//   0: 0x6E - I2C address 0x37, writing
+//   1: sub  - I2C sub address: 0x51 normally, 0x50 for the LG input side channel
+//   2: 0x8n - 0x80 | number of payload bytes that follow (checksum excluded)
+//   3..     - payload, opcode first (0x03 Set VCP, 0x01 Get VCP, 0xF3 Capabilities)
+//   last    - checksum: XOR of all preceding bytes, including the first
+//
+// Everything here is constexpr and touches no shared state, so frames for constant
+// arguments are computed at compile time and builders are safe on any thread.
+
+#define DDC_DEST_ADDR  0x6E
+#define DDC_HOST_ADDR  0x50  // virtual host address; seeds the checksum of replies
+
+// Wire offsets of a Set VCP Feature frame
+#define SET_VCPCODE_SUBADDRESS 1
+#define SET_VCPCODE_OFFSET     4
+#define SET_HIGH_OFFSET        5
+#define SET_LOW_OFFSET         6
+#define SET_CHK_OFFSET         7
+
+template <std::size_t N>
+struct DdcFrame {
+    unsigned char bytes[N];
+
+    constexpr const unsigned char* data() const { return bytes; }
+    static constexpr int size() { return (int)N; }
+    constexpr unsigned char operator[](std::size_t i) const { return bytes[i]; }
+};
+
+constexpr unsigned char DdcChecksum(const unsigned char* p, std::size_t len, unsigned char seed = 0)
+{
+    unsigned char chk = seed;
+    for (std::size_t i = 0; i < len; ++i) chk ^= p[i];
+    return chk;
+}
+
+// Any opcode, any payload length: address, subaddress, length byte, payload, checksum
+template <std::size_t P>
+constexpr DdcFrame<P + 4> MakeDdcFrame(unsigned char subaddress, const unsigned char (&payload)[P])
+{
+    static_assert(P <= 0x7F, "DDC/CI payload length must fit in the length byte");
+    DdcFrame<P + 4> f{};
+    f.bytes[0] = DDC_DEST_ADDR;
+    f.bytes[1] = subaddress;
+    f.bytes[2] = (unsigned char)(0x80 | P);
+    for (std::size_t i = 0; i < P; ++i) f.bytes[3 + i] = payload[i];
+    f.bytes[P + 3] = DdcChecksum(f.bytes, P + 3);
+    return f;
+}
+
+// Set VCP Feature (0x03): code, value high byte, value low byte
+constexpr DdcFrame<8> MakeSetVcpFrame(unsigned char subaddress, unsigned char vcpCode, unsigned int value)
+{
+    const unsigned char payload[4] = { 0x03, vcpCode,
+        (unsigned char)((value >> 8) & 0xFF), (unsigned char)(value & 0xFF) };
+    return MakeDdcFrame(subaddress, payload);
+}
+
+// Get VCP Feature (0x01): code
+constexpr DdcFrame<6> MakeGetVcpFrame(unsigned char subaddress, unsigned char vcpCode)
+{
+    const unsigned char payload[2] = { 0x01, vcpCode };
+    return MakeDdcFrame(subaddress, payload);
+}
+
+// Capabilities Request (0xF3): offset high byte, offset low byte
+constexpr DdcFrame<7> MakeCapabilitiesFrame(unsigned char subaddress, unsigned int offset)
+{
+    const unsigned char payload[3] = { 0xF3, (unsigned char)((offset >> 8) & 0xFF), (unsigned char)(offset & 0xFF) };
+    return MakeDdcFrame(subaddress, payload);
+}
+
+template <std::size_t N>
+constexpr bool DdcFrameEquals(const DdcFrame<N>& f, const unsigned char (&expected)[N])
+{
+    for (std::size_t i = 0; i < N; ++i)
+        if (f.bytes[i] != expected[i]) return false;
+    return true;
+}
+
+// Frames must stay byte-for-byte what the original ucSetCommandWrite template produced
+static_assert(DdcFrameEquals(MakeSetVcpFrame(0x50, 0xF4, 0xD1), { 0x6E, 0x50, 0x84, 0x03, 0xF4, 0x00, 0xD1, 0x9C }),
+    "LG side-channel USB-C frame");
+static_assert(DdcFrameEquals(MakeSetVcpFrame(0x51, 0x60, 0x0F), { 0x6E, 0x51, 0x84, 0x03, 0x60, 0x00, 0x0F, 0xD7 }),
+    "standard 0x60 input frame");
+static_assert(DdcFrameEquals(MakeGetVcpFrame(0x50, 0xF4), { 0x6E, 0x50, 0x82, 0x01, 0xF4, 0x49 }),
+    "Get VCP request frame");
+static_assert(DdcFrameEquals(MakeCapabilitiesFrame(0x51, 0x20), { 0x6E, 0x51, 0x83, 0xF3, 0x00, 0x20, 0x6F }),
+    "Capabilities request frame");
+
+#endif // !DDC_FRAME_H
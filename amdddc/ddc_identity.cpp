@@ -0,0 +1,124 @@
+#include "ddc_identity.h"
+#include "ddc_transport.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+
+static const IdentifiedDisplay* FindSame(const std::vector<IdentifiedDisplay>* previous, const DdcDisplayInfo& d)
+{
+    if (!previous) return nullptr;
+    for (const auto& p : *previous)
+        if (p.adapterIdx == d.adapterIdx && p.displayIdx == d.displayIdx && p.name == d.name && p.id.Valid())
+            return &p;
+    return nullptr;
+}
+
+std::vector<IdentifiedDisplay> EnumerateIdentifiedDisplays(const std::vector<IdentifiedDisplay>* previous)
+{
+    std::vector<IdentifiedDisplay> out;
+    DdcTransport* transport = ActiveTransport();
+    if (!transport->Open()) return out;
+
+    std::vector<DdcDisplayInfo> displays;
+    if (transport->Enumerate(displays) != ADL_OK) return out;
+
+    for (const auto& d : displays) {
+        IdentifiedDisplay item;
+        item.adapterIdx = d.adapterIdx;
+        item.displayIdx = d.displayIdx;
+        item.name = d.name;
+
+        if (const IdentifiedDisplay* same = FindSame(previous, d)) {
+            item.id = same->id;
+            out.push_back(item);
+            continue;
+        }
+
+        unsigned char edid[256] = {};
+        int edidLen = (int)sizeof(edid);
+        if (transport->ReadEdid(d.adapterIdx, d.displayIdx, edid, &edidLen) == ADL_OK)
+            ParseEdidIdentity(edid, edidLen, item.id);
+        out.push_back(item);
+    }
+    return out;
+}
+
+std::vector<IdentifiedAdapter> EnumerateTopology()
+{
+    std::vector<IdentifiedAdapter> out;
+    std::vector<DdcAdapterInfo> adapters;
+    if (!ActiveTransport()->Open() || ActiveTransport()->EnumerateAdapters(adapters) != ADL_OK) return out;
+
+    for (const auto& a : adapters) {
+        IdentifiedAdapter item;
+        item.adapterIdx = a.adapterIdx;
+        item.name = a.name;
+        out.push_back(item);
+    }
+    for (auto& d : EnumerateIdentifiedDisplays()) {
+        auto it = out.begin();
+        while (it != out.end() && it->adapterIdx != d.adapterIdx) ++it;
+        if (it == out.end()) {
+            // Topology changed between the two walks
+            IdentifiedAdapter item;
+            item.adapterIdx = d.adapterIdx;
+            it = out.insert(out.end(), item);
+        }
+        it->displays.push_back(std::move(d));
+    }
+    return out;
+}
+
+// ---------- Cached map ----------
+
+using Clock = std::chrono::steady_clock;
+
+static std::mutex g_mapLock;
+static std::multimap<EdidIdentity, std::pair<int, int>> g_map; // identity -> {adapter, display}
+static bool g_mapBuilt = false;
+static Clock::time_point g_mapBuiltAt;
+
+static void RebuildLocked()
+{
+    g_map.clear();
+    for (const auto& d : EnumerateIdentifiedDisplays())
+        if (d.id.Valid()) g_map.emplace(d.id, std::make_pair(d.adapterIdx, d.displayIdx));
+    g_mapBuilt = true;
+    g_mapBuiltAt = Clock::now();
+}
+
+// Exact match on the hint first, otherwise the first display with that identity
+static bool LookupLocked(const EdidIdentity& id, int& ioAdapterIdx, int& ioDisplayIdx)
+{
+    auto range = g_map.equal_range(id);
+    if (range.first == range.second) return false;
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.first == ioAdapterIdx && it->second.second == ioDisplayIdx) return true;
+    }
+    ioAdapterIdx = range.first->second.first;
+    ioDisplayIdx = range.first->second.second;
+    return true;
+}
+
+bool ResolveDisplay(const EdidIdentity& id, int& ioAdapterIdx, int& ioDisplayIdx)
+{
+    if (!id.Valid()) return false;
+
+    std::lock_guard<std::mutex> lock(g_mapLock);
+    if (g_mapBuilt && LookupLocked(id, ioAdapterIdx, ioDisplayIdx)) return true;
+
+    const bool recent = g_mapBuilt &&
+        Clock::now() - g_mapBuiltAt < std::chrono::milliseconds(DDC_DISPLAY_MAP_MIN_REBUILD_MS);
+    if (recent) return false;
+
+    RebuildLocked();
+    return LookupLocked(id, ioAdapterIdx, ioDisplayIdx);
+}
+
+void InvalidateDisplayMap()
+{
+    std::lock_guard<std::mutex> lock(g_mapLock);
+    g_map.clear();
+    g_mapBuilt = false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef DDC_IDENTITY_H
+#define DDC_IDENTITY_H
+
+#include "ddc_edid.h"
+#include <string>
+#include <vector>
+
+// Stable display identity on top of the transport's enumeration.
+//
+// Adapter/display indices move around across driver updates and reconnects, so
+// callers store the EDID identity and resolve it to indices when they need them.
+// Resolution goes through a process-wide map that is only rebuilt (one enumeration
+// plus one EDID read per display) when a lookup misses or after InvalidateDisplayMap.
+
+struct IdentifiedDisplay {
+    int adapterIdx = 0;
+    int displayIdx = 0;
+    std::string name;
+    EdidIdentity id;    // invalid when the EDID couldn't be read
+};
+
+// An adapter and the identified displays on it
+struct IdentifiedAdapter {
+    int adapterIdx = 0;
+    std::string name;   // empty where the transport has no adapter names
+    std::vector<IdentifiedDisplay> displays;
+};
+
+// Misses within this long of the last rebuild reuse the map, so a monitor that is
+// switched off doesn't cost a full walk on every hotkey press.
+#define DDC_DISPLAY_MAP_MIN_REBUILD_MS 2000
+
+// Walk of the active transport with each display's EDID identity. Doesn't touch the map.
+// With previous, a display still at the same indices under the same name keeps its
+// identity and only new or changed entries have their EDID read.
+std::vector<IdentifiedDisplay> EnumerateIdentifiedDisplays(const std::vector<IdentifiedDisplay>* previous = nullptr);
+
+// The same walk grouped by adapter, in the transport's order, with adapters that have
+// nothing connected. Only call-local buffers, so any thread may walk at any time.
+std::vector<IdentifiedAdapter> EnumerateTopology();
+
+// Looks id up in the map, rebuilding it on a miss. On entry the indices are where the
+// display was last seen; they pick between identical identities (monitors without a
+// serial number). Returns false and leaves them untouched if the display isn't connected.
+bool ResolveDisplay(const EdidIdentity& id, int& ioAdapterIdx, int& ioDisplayIdx);
+
+// Topology changed (display added/removed/moved): the next lookup rebuilds.
+void InvalidateDisplayMap();
+
+#endif // !DDC_IDENTITY_H
@@ -0,0 +1,72 @@
+#include "ddc_latency.h"
+#include "ddc_transport.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+
+void DdcLatencyProfile::Add(unsigned int ms)
+{
+    if (ms > DDC_LATENCY_MAX_MS) ms = DDC_LATENCY_MAX_MS;
+    ewmaMs = samples == 0 ? (double)ms : DDC_LATENCY_EWMA_ALPHA * ms + (1.0 - DDC_LATENCY_EWMA_ALPHA) * ewmaMs;
+    ++samples;
+    recent.push_back(ms);
+    if (recent.size() > DDC_LATENCY_RING) recent.erase(recent.begin());
+}
+
+unsigned int DdcLatencyProfile::P95Ms() const
+{
+    if (recent.empty()) return 0;
+    std::vector<unsigned int> sorted(recent);
+    std::sort(sorted.begin(), sorted.end());
+    // Nearest rank
+    size_t rank = (sorted.size() * 95 + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+unsigned int FirstPollDelayMs(const DdcLatencyProfile& p, unsigned int deadlineMs)
+{
+    unsigned int delay = DDC_WRITE_GAP_MS;
+    if (p.Trained()) {
+        // 80% of the typical latency leaves room for a faster-than-usual switch
+        const unsigned int typical = (unsigned int)(p.ewmaMs * 0.8);
+        if (typical > delay) delay = typical;
+    }
+    return delay < deadlineMs ? delay : deadlineMs;
+}
+
+unsigned int SettleDeadlineMs(const DdcLatencyProfile& p, unsigned int configuredMs)
+{
+    if (!p.Trained()) return configuredMs;
+    const unsigned int p95 = p.P95Ms();
+    unsigned int deadline = p95 * 2;
+    if (deadline < p95 + DDC_LATENCY_MIN_HEADROOM_MS) deadline = p95 + DDC_LATENCY_MIN_HEADROOM_MS;
+    return deadline < configuredMs ? deadline : configuredMs;
+}
+
+// ---------- Registry ----------
+
+static std::mutex g_lock;
+static std::map<std::pair<int, int>, DdcLatencyProfile> g_profiles;
+
+void RecordSwitchLatency(int adapterIdx, int displayIdx, unsigned int ms)
+{
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_profiles[{ adapterIdx, displayIdx }].Add(ms);
+}
+
+bool GetLatencyProfile(int adapterIdx, int displayIdx, DdcLatencyProfile& out)
+{
+    std::lock_guard<std::mutex> lock(g_lock);
+    auto it = g_profiles.find({ adapterIdx, displayIdx });
+    if (it == g_profiles.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void SeedLatencyProfile(int adapterIdx, int displayIdx, const DdcLatencyProfile& p)
+{
+    if (p.samples == 0) return;
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_profiles.emplace(std::make_pair(adapterIdx, displayIdx), p);
+}
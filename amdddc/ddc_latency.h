@@ -0,0 +1,46 @@
+#pragma once
+#ifndef DDC_LATENCY_H
+#define DDC_LATENCY_H
+
+#include <vector>
+
+// Learned switch latency per display: write -> monitor reports the new input.
+//
+// Monitors differ a lot (a 45" OLED can take several times as long as a 27" IPS), so
+// the settle poll is scheduled from each display's own history instead of one constant:
+// the first Get VCP goes out shortly before the display usually confirms, rather than
+// right after the write gap while it is still re-syncing.
+
+#define DDC_LATENCY_RING            32  // samples kept for the percentile
+#define DDC_LATENCY_EWMA_ALPHA      0.2
+#define DDC_LATENCY_MIN_SAMPLES     3   // below this the default schedule is used
+#define DDC_LATENCY_MIN_HEADROOM_MS 250 // least extra time a learned deadline gives over the p95
+#define DDC_LATENCY_MAX_MS          60000 // samples (and a loaded EWMA) are capped here
+
+struct DdcLatencyProfile {
+    double ewmaMs = 0.0;
+    unsigned int samples = 0;            // total recorded, not capped by the ring
+    std::vector<unsigned int> recent;    // last DDC_LATENCY_RING samples, oldest first
+
+    void Add(unsigned int ms);
+    unsigned int P95Ms() const;
+    bool Trained() const { return samples >= DDC_LATENCY_MIN_SAMPLES; }
+};
+
+// Delay from the write to the first settle poll: a bit before the usual confirmation,
+// never sooner than the DDC/CI write gap and never past the deadline.
+unsigned int FirstPollDelayMs(const DdcLatencyProfile& p, unsigned int deadlineMs);
+
+// Deadline for this display: twice its p95 (at least DDC_LATENCY_MIN_HEADROOM_MS over it),
+// capped by the configured one. Untrained displays get the configured deadline.
+unsigned int SettleDeadlineMs(const DdcLatencyProfile& p, unsigned int configuredMs);
+
+// Process-wide profiles by {adapter, display}. The switch path records into these (a
+// switch that missed its deadline as the deadline itself, a lower bound); the app seeds
+// them from config.json and copies them back to persist them.
+void RecordSwitchLatency(int adapterIdx, int displayIdx, unsigned int ms);
+bool GetLatencyProfile(int adapterIdx, int displayIdx, DdcLatencyProfile& out);
+// Only fills in a display that has no profile in this process yet
+void SeedLatencyProfile(int adapterIdx, int displayIdx, const DdcLatencyProfile& p);
+
+#endif // !DDC_LATENCY_H
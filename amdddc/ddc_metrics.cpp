@@ -0,0 +1,283 @@
+#include "ddc_metrics.h"
+#include "../external/json.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using json = nlohmann::json;
+
+// ---------- Names ----------
+
+const char* DdcMetricName(DdcMetric m)
+{
+    switch (m) {
+    case DdcMetric::queueWait: return "queueWait";
+    case DdcMetric::adlCall:   return "adlCall";
+    case DdcMetric::settle:    return "settle";
+    case DdcMetric::endToEnd:  return "endToEnd";
+    default:                   return "?";
+    }
+}
+
+const char* DdcCounterName(DdcCounter c)
+{
+    switch (c) {
+    case DdcCounter::success:       return "successes";
+    case DdcCounter::failure:       return "failures";
+    case DdcCounter::retry:         return "retries";
+    case DdcCounter::checksumError: return "checksumErrors";
+    default:                        return "?";
+    }
+}
+
+// ---------- Buckets ----------
+
+// Index of the highest set bit; v != 0
+static int TopBit(std::uint64_t v)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanReverse64(&i, v);
+    return (int)i;
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+// Below 2 * DDC_METRICS_SUB_BUCKETS every value has its own bucket; above, each power of
+// two is split into DDC_METRICS_SUB_BUCKETS equal buckets.
+static const int LINEAR_LIMIT = 2 * DDC_METRICS_SUB_BUCKETS;
+static const int SUB_BITS = 4; // log2(DDC_METRICS_SUB_BUCKETS)
+
+static int BucketIndex(std::uint64_t v)
+{
+    if (v < (std::uint64_t)LINEAR_LIMIT) return (int)v;
+    const int top = TopBit(v);
+    const int idx = (top - SUB_BITS + 1) * DDC_METRICS_SUB_BUCKETS +
+        (int)(v >> (top - SUB_BITS)) - DDC_METRICS_SUB_BUCKETS;
+    return idx < DDC_METRICS_BUCKETS ? idx : DDC_METRICS_BUCKETS - 1;
+}
+
+static std::uint64_t BucketLow(int idx)
+{
+    if (idx < LINEAR_LIMIT) return (std::uint64_t)idx;
+    const int top = idx / DDC_METRICS_SUB_BUCKETS + SUB_BITS - 1;
+    return (std::uint64_t)(idx % DDC_METRICS_SUB_BUCKETS + DDC_METRICS_SUB_BUCKETS) << (top - SUB_BITS);
+}
+
+// Largest value that lands in the bucket starting at low
+static std::uint64_t BucketHigh(std::uint64_t low)
+{
+    if (low < (std::uint64_t)LINEAR_LIMIT) return low;
+    return low + ((std::uint64_t)1 << (TopBit(low) - SUB_BITS)) - 1;
+}
+
+std::uint64_t DdcHistogramSnapshot::PercentileUs(double q) const
+{
+    if (!count) return 0;
+    if (q < 0) q = 0;
+    if (q > 1) q = 1;
+    // Rank of the value we're after, 1-based
+    std::uint64_t rank = (std::uint64_t)(q * (double)count + 0.5);
+    if (rank < 1) rank = 1;
+
+    std::uint64_t seen = 0;
+    for (const auto& b : buckets) {
+        seen += b.second;
+        if (seen >= rank) {
+            const std::uint64_t high = BucketHigh(b.first);
+            return high < maxUs ? high : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+// ---------- Recording ----------
+
+struct Histogram {
+    std::atomic<std::uint64_t> counts[DDC_METRICS_BUCKETS] = {};
+    std::atomic<std::uint64_t> count{ 0 };
+    std::atomic<std::uint64_t> sumUs{ 0 };
+    std::atomic<std::uint64_t> maxUs{ 0 };
+};
+
+static Histogram g_latency[(int)DdcMetric::count];
+
+static std::mutex g_countersLock;
+static std::map<std::pair<int, int>, DdcTargetCounters> g_counters;
+static std::map<std::string, std::uint64_t> g_phasesMs;   // guarded by g_countersLock
+static std::map<std::string, std::uint64_t> g_gauges;     // guarded by g_countersLock
+
+void RecordDdcLatencyUs(DdcMetric m, std::uint64_t us)
+{
+    if ((int)m < 0 || m >= DdcMetric::count) return;
+    Histogram& h = g_latency[(int)m];
+    h.counts[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sumUs.fetch_add(us, std::memory_order_relaxed);
+    std::uint64_t cur = h.maxUs.load(std::memory_order_relaxed);
+    while (us > cur && !h.maxUs.compare_exchange_weak(cur, us, std::memory_order_relaxed)) {}
+}
+
+// Events happen once per switch or reply, not per byte, so a plain lock is fine here
+void CountDdcEvent(int adapterIdx, int displayIdx, DdcCounter c, unsigned int n)
+{
+    if ((int)c < 0 || c >= DdcCounter::count || n == 0) return;
+    std::lock_guard<std::mutex> lock(g_countersLock);
+    DdcTargetCounters& t = g_counters[{ adapterIdx, displayIdx }];
+    t.adapterIdx = adapterIdx;
+    t.displayIdx = displayIdx;
+    t.counts[(int)c] += n;
+}
+
+void RecordDdcPhaseMs(const std::string& name, std::uint64_t ms)
+{
+    std::lock_guard<std::mutex> lock(g_countersLock);
+    g_phasesMs[name] = ms;
+}
+
+void SetDdcGauge(const std::string& name, std::uint64_t value)
+{
+    std::lock_guard<std::mutex> lock(g_countersLock);
+    g_gauges[name] = value;
+}
+
+DdcMetricsSnapshot SnapshotDdcMetrics()
+{
+    DdcMetricsSnapshot s;
+    s.wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Not one atomic cut across buckets: a value recorded meanwhile may be missing from
+    // the total or from its bucket, which is noise at these rates
+    for (int m = 0; m < (int)DdcMetric::count; ++m) {
+        const Histogram& h = g_latency[m];
+        DdcHistogramSnapshot& out = s.latency[m];
+        for (int i = 0; i < DDC_METRICS_BUCKETS; ++i) {
+            const std::uint64_t n = h.counts[i].load(std::memory_order_relaxed);
+            if (n) {
+                out.buckets.emplace_back(BucketLow(i), n);
+                out.count += n;
+            }
+        }
+        out.sumUs = h.sumUs.load(std::memory_order_relaxed);
+        out.maxUs = h.maxUs.load(std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(g_countersLock);
+    for (const auto& kv : g_counters) s.targets.push_back(kv.second);
+    s.phasesMs.assign(g_phasesMs.begin(), g_phasesMs.end());
+    s.gauges.assign(g_gauges.begin(), g_gauges.end());
+    return s;
+}
+
+// ---------- JSON ----------
+
+std::string DdcMetricsToJson(const DdcMetricsSnapshot& s)
+{
+    json j;
+    j["wallMs"] = s.wallMs;
+
+    json lat = json::object();
+    for (int m = 0; m < (int)DdcMetric::count; ++m) {
+        const DdcHistogramSnapshot& h = s.latency[m];
+        json buckets = json::array();
+        for (const auto& b : h.buckets) buckets.push_back({ b.first, b.second });
+        lat[DdcMetricName((DdcMetric)m)] = {
+            { "count", h.count },
+            { "sumUs", h.sumUs },
+            { "maxUs", h.maxUs },
+            { "p50Us", h.PercentileUs(0.50) },
+            { "p90Us", h.PercentileUs(0.90) },
+            { "p99Us", h.PercentileUs(0.99) },
+            { "buckets", buckets }
+        };
+    }
+    j["latency"] = lat;
+
+    json targets = json::array();
+    for (const auto& t : s.targets) {
+        json o = { { "adapter", t.adapterIdx }, { "display", t.displayIdx } };
+        for (int c = 0; c < (int)DdcCounter::count; ++c) o[DdcCounterName((DdcCounter)c)] = t.counts[c];
+        targets.push_back(o);
+    }
+    j["targets"] = targets;
+
+    json phases = json::object();
+    for (const auto& p : s.phasesMs) phases[p.first] = p.second;
+    j["phasesMs"] = phases;
+
+    json gauges = json::object();
+    for (const auto& g : s.gauges) gauges[g.first] = g.second;
+    j["gauges"] = gauges;
+    return j.dump(2);
+}
+
+bool DdcMetricsFromJson(const std::string& text, DdcMetricsSnapshot& out)
+{
+    json j = json::parse(text, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || !j.contains("latency")) return false;
+
+    out = DdcMetricsSnapshot();
+    try {
+        out.wallMs = j.value("wallMs", 0LL);
+        const json& lat = j["latency"];
+        for (int m = 0; m < (int)DdcMetric::count; ++m) {
+            const char* name = DdcMetricName((DdcMetric)m);
+            if (!lat.contains(name)) continue;
+            const json& h = lat[name];
+            DdcHistogramSnapshot& dst = out.latency[m];
+            dst.sumUs = h.value("sumUs", (std::uint64_t)0);
+            dst.maxUs = h.value("maxUs", (std::uint64_t)0);
+            if (h.contains("buckets")) {
+                for (const auto& b : h["buckets"]) {
+                    dst.buckets.emplace_back(b.at(0).get<std::uint64_t>(), b.at(1).get<std::uint64_t>());
+                    dst.count += dst.buckets.back().second;
+                }
+            }
+        }
+        if (j.contains("targets")) {
+            for (const auto& o : j["targets"]) {
+                DdcTargetCounters t;
+                t.adapterIdx = o.value("adapter", 0);
+                t.displayIdx = o.value("display", 0);
+                for (int c = 0; c < (int)DdcCounter::count; ++c)
+                    t.counts[c] = o.value(DdcCounterName((DdcCounter)c), (std::uint64_t)0);
+                out.targets.push_back(t);
+            }
+        }
+        if (j.contains("phasesMs")) {
+            for (const auto& p : j["phasesMs"].items())
+                out.phasesMs.emplace_back(p.key(), p.value().get<std::uint64_t>());
+        }
+        if (j.contains("gauges")) {
+            for (const auto& g : j["gauges"].items())
+                out.gauges.emplace_back(g.key(), g.value().get<std::uint64_t>());
+        }
+    }
+    catch (const json::exception&) {
+        return false;
+    }
+    return true;
+}
+
+bool WriteDdcMetricsFile(const std::string& path)
+{
+    // Written aside and renamed over, so a reader never sees half a file
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) return false;
+        f << DdcMetricsToJson(SnapshotDdcMetrics());
+        if (!f) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef DDC_METRICS_H
+#define DDC_METRICS_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Where the time goes between a hotkey and the monitor switching.
+//
+// Latencies go into fixed log-linear histograms (HDR style: 16 buckets per power of two,
+// so any recorded value is within ~6% of its bucket) of microseconds, from 1 us to about
+// 12 days. Recording is a bucket index computed from the value's top bit plus a few
+// relaxed atomic adds: no locks and no allocation, cheap enough to leave on. Event counts
+// are kept per {adapter, display}.
+
+#define DDC_METRICS_SUB_BUCKETS 16   // per power of two; a power of two itself
+#define DDC_METRICS_BUCKETS     592  // covers values below 2^40 us
+
+enum class DdcMetric {
+    queueWait,      // hotkey queued -> switch worker picks it up (app)
+    adlCall,        // one transport call: a write, or a write plus reply read
+    settle,         // write -> monitor reads back the new value (or the deadline)
+    endToEnd,       // hotkey queued -> every display switched (app)
+    count
+};
+
+enum class DdcCounter {
+    success,        // a switch or value write that went through (and read back, where it can)
+    failure,        // failed, or the monitor kept reading back another value
+    retry,          // extra write attempts after the first
+    checksumError,  // replies that didn't validate
+    count
+};
+
+const char* DdcMetricName(DdcMetric m);
+const char* DdcCounterName(DdcCounter c);
+
+// Hot path
+void RecordDdcLatencyUs(DdcMetric m, std::uint64_t us);
+void CountDdcEvent(int adapterIdx, int displayIdx, DdcCounter c, unsigned int n = 1);
+
+// One-off durations such as startup phases ("transportOpen", "loadConfig"); a name
+// recorded again keeps the latest value
+void RecordDdcPhaseMs(const std::string& name, std::uint64_t ms);
+
+// Current value of a process-wide quantity that lives elsewhere, e.g. the tray's switch
+// queue depth ("queueDepth", "queueMaxDepth") or the retry outcomes (ddc_retry.h); set
+// again, it keeps the latest value
+void SetDdcGauge(const std::string& name, std::uint64_t value);
+
+struct DdcHistogramSnapshot {
+    std::uint64_t count = 0;
+    std::uint64_t sumUs = 0;
+    std::uint64_t maxUs = 0;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> buckets; // {lowest value in bucket, count}, non-empty only
+
+    // Upper edge of the bucket holding the q-th value (0..1), capped at maxUs; 0 when empty
+    std::uint64_t PercentileUs(double q) const;
+    std::uint64_t MeanUs() const { return count ? sumUs / count : 0; }
+};
+
+struct DdcTargetCounters {
+    int adapterIdx = 0;
+    int displayIdx = 0;
+    std::uint64_t counts[(int)DdcCounter::count] = {};
+};
+
+struct DdcMetricsSnapshot {
+    long long wallMs = 0;     // when it was taken, Unix time
+    DdcHistogramSnapshot latency[(int)DdcMetric::count];
+    std::vector<DdcTargetCounters> targets;
+    std::vector<std::pair<std::string, std::uint64_t>> phasesMs;  // by name
+    std::vector<std::pair<std::string, std::uint64_t>> gauges;    // by name
+};
+
+DdcMetricsSnapshot SnapshotDdcMetrics();
+
+// JSON dump of a snapshot (with the buckets, so percentiles can be recomputed after
+// loading it) and the reverse, for `amdddc-windows stats <file>`
+std::string DdcMetricsToJson(const DdcMetricsSnapshot& s);
+bool DdcMetricsFromJson(const std::string& json, DdcMetricsSnapshot& out);
+bool WriteDdcMetricsFile(const std::string& path);
+
+#endif // !DDC_METRICS_H
@@ -0,0 +1,103 @@
+#include "ddc_reply.h"
+#include "ddc_bus.h"
+#include "ddc_frame.h"
+#include "ddc_metrics.h"
+#include "ddc_transport.h"
+#include "../adl-sdk/include/adl_defines.h"
+
+// ---------- Parser ----------
+
+void DdcReplyParser::Reset()
+{
+    m_phase = Phase::source;
+    m_state = State::needMore;
+    m_error = Error::none;
+    m_chk = DDC_HOST_ADDR;
+    m_expected = 0;
+    m_got = 0;
+}
+
+DdcReplyParser::State DdcReplyParser::Feed(unsigned char b)
+{
+    if (m_state != State::needMore) return m_state;
+
+    switch (m_phase) {
+    case Phase::source:
+        if (b != DDC_DEST_ADDR) {
+            m_error = Error::badSource;
+            return m_state = State::error;
+        }
+        m_chk ^= b;
+        m_phase = Phase::length;
+        break;
+    case Phase::length:
+        if ((b & 0x80) == 0) {
+            m_error = Error::badLength;
+            return m_state = State::error;
+        }
+        m_chk ^= b;
+        m_expected = b & 0x7F;
+        m_phase = m_expected ? Phase::payload : Phase::checksum;
+        break;
+    case Phase::payload:
+        m_chk ^= b;
+        m_payload[m_got++] = b;
+        if (m_got == m_expected) m_phase = Phase::checksum;
+        break;
+    case Phase::checksum:
+        m_phase = Phase::done;
+        if (b != m_chk) {
+            m_error = Error::badChecksum;
+            return m_state = State::error;
+        }
+        return m_state = State::complete;
+    case Phase::done:
+        break;
+    }
+    return m_state;
+}
+
+DdcReplyParser::State DdcReplyParser::Feed(const unsigned char* data, int len)
+{
+    for (int i = 0; i < len && m_state == State::needMore; ++i) Feed(data[i]);
+    return m_state;
+}
+
+// ---------- Get VCP Feature ----------
+
+int DecodeGetVcpReply(const DdcReplyParser& parser, unsigned char vcpCode, VcpReply& out)
+{
+    if (parser.state() == DdcReplyParser::State::error) return DDC_ERR_CHECKSUM;
+    if (parser.state() != DdcReplyParser::State::complete) return DDC_ERR_BAD_REPLY;
+    if (parser.IsNullMessage()) return DDC_ERR_NULL_REPLY;
+
+    // 0x02, result, code, type, max hi/lo, cur hi/lo
+    const unsigned char* p = parser.Payload();
+    if (parser.PayloadLen() != 8 || p[0] != 0x02) return DDC_ERR_BAD_REPLY;
+    if (p[2] != vcpCode) return DDC_ERR_BAD_REPLY;
+    if (p[1] != 0x00) return DDC_ERR_UNSUPPORTED_VCP;
+
+    out.code = p[2];
+    out.type = p[3];
+    out.max = (unsigned short)((p[4] << 8) | p[5]);
+    out.cur = (unsigned short)((p[6] << 8) | p[7]);
+    return 0;
+}
+
+int GetVcpFeature(int adapterIdx, int displayIdx, unsigned int subaddress,
+    unsigned char vcpCode, VcpReply& out)
+{
+    const auto req = MakeGetVcpFrame((unsigned char)subaddress, vcpCode);
+
+    // 11 bytes for a full reply; a little slack for drivers that pad
+    unsigned char reply[16] = {};
+    int replyLen = (int)sizeof(reply);
+    int rc = DdcBusWriteRead(adapterIdx, displayIdx, req.data(), req.size(), reply, &replyLen);
+    if (rc != ADL_OK) return rc;
+
+    DdcReplyParser parser;
+    parser.Feed(reply, replyLen);
+    rc = DecodeGetVcpReply(parser, vcpCode, out);
+    if (rc == DDC_ERR_CHECKSUM) CountDdcEvent(adapterIdx, displayIdx, DdcCounter::checksumError);
+    return rc;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef DDC_REPLY_H
+#define DDC_REPLY_H
+
+// DDC/CI reply handling: an incremental parser for reply frames and the Get VCP
+// Feature request/reply exchange built on it.
+//
+// Reply frame on the wire:
+//   0: 0x6E  - source address (display)
+//   1: 0x8n  - 0x80 | number of payload bytes that follow
+//   2..n+1   - payload (opcode first)
+//   n+2      - checksum: 0x50 (host virtual address) XOR every preceding byte
+
+// Largest payload the length byte can announce
+#define DDC_MAX_REPLY_PAYLOAD 0x7F
+
+class DdcReplyParser {
+public:
+    enum class State { needMore, complete, error };
+    enum class Error { none, badSource, badLength, badChecksum };
+
+    DdcReplyParser() { Reset(); }
+
+    void Reset();
+
+    // Feed bytes as they arrive. Stops consuming at the end of a frame or on the first
+    // error; trailing bytes (e.g. driver padding) are ignored. Returns the new state.
+    State Feed(unsigned char b);
+    State Feed(const unsigned char* data, int len);
+
+    State state() const { return m_state; }
+    Error error() const { return m_error; }
+
+    // Valid once state() == complete. A zero-length payload is the DDC/CI "null message"
+    // a display sends when it is busy or has nothing to report.
+    const unsigned char* Payload() const { return m_payload; }
+    int PayloadLen() const { return m_expected; }
+    bool IsNullMessage() const { return m_state == State::complete && m_expected == 0; }
+
+private:
+    enum class Phase { source, length, payload, checksum, done };
+
+    Phase m_phase;
+    State m_state;
+    Error m_error;
+    unsigned char m_chk;
+    int m_expected;
+    int m_got;
+    unsigned char m_payload[DDC_MAX_REPLY_PAYLOAD];
+};
+
+// Decoded Get VCP Feature reply (opcode 0x02)
+struct VcpReply {
+    unsigned char code = 0;
+    unsigned char type = 0;     // 0x00 set parameter, 0x01 momentary
+    unsigned short max = 0;
+    unsigned short cur = 0;
+};
+
+// Status codes beyond the transport's ADL codes
+#define DDC_ERR_BAD_REPLY       -100  // wrong opcode/length, or reply for another VCP code
+#define DDC_ERR_CHECKSUM        -101  // reply checksum or length byte didn't validate
+#define DDC_ERR_UNSUPPORTED_VCP -102  // display answered "unsupported VCP code"
+#define DDC_ERR_NULL_REPLY      -103  // display sent the null message (busy)
+#define DDC_ERR_NOT_CONNECTED   -104  // target's EDID identity isn't on any adapter; nothing written
+
+// Interprets a complete parsed payload as a reply for vcpCode. Returns 0 or a DDC_ERR_* code.
+int DecodeGetVcpReply(const DdcReplyParser& parser, unsigned char vcpCode, VcpReply& out);
+
+// One Get VCP Feature round trip (0x01 request -> 0x02 reply) over the active transport.
+// Returns 0, an ADL error code from the transport, or a DDC_ERR_* code.
+int GetVcpFeature(int adapterIdx, int displayIdx, unsigned int subaddress,
+    unsigned char vcpCode, VcpReply& out);
+
+#endif // !DDC_REPLY_H
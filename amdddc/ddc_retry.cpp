@@ -0,0 +1,137 @@
+#include "ddc_retry.h"
+#include "ddc_metrics.h"
+#include "ddc_reply.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+DdcErrorClass ClassifyDdcError(int rc)
+{
+    switch (rc) {
+    case 0:
+        return DdcErrorClass::none;
+
+    case ADL_ERR:                       // NAK, arbitration lost, bus error
+    case DDC_ERR_BAD_REPLY:
+    case DDC_ERR_CHECKSUM:
+        return DdcErrorClass::transient;
+
+    case ADL_ERR_RESOURCE_CONFLICT:
+    case ADL_ERR_SERVER_BUSY:
+    case ADL_ERR_GPU_IN_USE:
+    case ADL_ERR_INVALID_POWER_STATE:   // GPU still waking up after resume
+    case DDC_ERR_NULL_REPLY:
+        return DdcErrorClass::busy;
+
+    default:                            // bad index, unsupported, no privileges, ...
+        return DdcErrorClass::fatal;
+    }
+}
+
+const char* DdcErrorClassName(DdcErrorClass c)
+{
+    switch (c) {
+    case DdcErrorClass::none:      return "ok";
+    case DdcErrorClass::transient: return "transient";
+    case DdcErrorClass::busy:      return "busy";
+    case DdcErrorClass::mismatch:  return "mismatch";
+    case DdcErrorClass::fatal:     return "fatal";
+    }
+    return "?";
+}
+
+static unsigned int MsBetween(Clock::time_point a, Clock::time_point b)
+{
+    return (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+}
+
+// Half-jitter: somewhere in [base/2, base], so retries from parallel buses spread out
+static unsigned int Jitter(unsigned int baseMs)
+{
+    thread_local std::minstd_rand rng((unsigned int)Clock::now().time_since_epoch().count() ^
+        (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id()));
+    if (baseMs < 2) return baseMs;
+    std::uniform_int_distribution<unsigned int> dist(baseMs / 2, baseMs);
+    return dist(rng);
+}
+
+DdcRetryOutcome RunWithRetry(const DdcRetryPolicy& policy, const std::function<int()>& op)
+{
+    DdcRetryOutcome out;
+    const Clock::time_point begin = Clock::now();
+    unsigned int base = policy.initialBackoffMs;
+
+    for (int n = 0; n < policy.maxAttempts; ++n) {
+        DdcAttempt a;
+        const Clock::time_point started = Clock::now();
+        a.startMs = MsBetween(begin, started);
+        a.rc = op();
+        a.durationMs = MsBetween(started, Clock::now());
+        a.cls = ClassifyDdcError(a.rc);
+
+        out.rc = a.rc;
+        out.cls = a.cls;
+        if (a.cls == DdcErrorClass::none || a.cls == DdcErrorClass::fatal) {
+            out.attempts.push_back(a);
+            break;
+        }
+
+        // The bus scheduler adds whatever is left of the DDC/CI gap on top (ddc_bus.h)
+        const unsigned int backoff = Jitter(base);
+        base = base * 2 > policy.maxBackoffMs ? policy.maxBackoffMs : base * 2;
+
+        const bool lastAttempt = n + 1 >= policy.maxAttempts;
+        const bool overBudget = MsBetween(begin, Clock::now()) + backoff > policy.budgetMs;
+        if (lastAttempt || overBudget) {
+            out.attempts.push_back(a);
+            out.budgetExhausted = true;
+            break;
+        }
+
+        a.backoffMs = backoff;
+        out.attempts.push_back(a);
+        std::this_thread::sleep_for(std::chrono::milliseconds(backoff));
+    }
+
+    out.elapsedMs = MsBetween(begin, Clock::now());
+    return out;
+}
+
+// ---------- Stats ----------
+
+static std::mutex g_statsLock;
+static DdcRetryStats g_stats;
+
+void RecordDdcRetry(const DdcRetryOutcome& outcome)
+{
+    std::lock_guard<std::mutex> lock(g_statsLock);
+    ++g_stats.operations;
+    g_stats.attempts += outcome.attempts.size();
+    for (const auto& a : outcome.attempts)
+        if (a.cls != DdcErrorClass::none) ++g_stats.byClass[(int)a.cls];
+
+    if (outcome.cls == DdcErrorClass::none) {
+        if (outcome.attempts.size() > 1) ++g_stats.recovered;
+    } else if (outcome.cls == DdcErrorClass::fatal) {
+        ++g_stats.fatal;
+    } else {
+        ++g_stats.exhausted;
+    }
+
+    // So the metrics dump and `stats` show them
+    SetDdcGauge("retryOperations", g_stats.operations);
+    SetDdcGauge("retryAttempts", g_stats.attempts);
+    SetDdcGauge("retryRecovered", g_stats.recovered);
+    SetDdcGauge("retryExhausted", g_stats.exhausted);
+    SetDdcGauge("retryFatal", g_stats.fatal);
+}
+
+DdcRetryStats GetDdcRetryStats()
+{
+    std::lock_guard<std::mutex> lock(g_statsLock);
+    return g_stats;
+}
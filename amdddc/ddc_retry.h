@@ -0,0 +1,64 @@
+#pragma once
+#ifndef DDC_RETRY_H
+#define DDC_RETRY_H
+
+#include <functional>
+#include <vector>
+
+// Bounded retries for DDC/CI operations.
+//
+// Status codes are sorted into classes that decide whether another attempt can help:
+//   transient - NAK / bus error / garbled reply; the next attempt usually succeeds
+//   busy      - driver or display busy (null message, resource conflict, power state
+//               after resume); worth retrying once the DDC/CI write gap has passed
+//   mismatch  - the write went through but the monitor reads back another value
+//   fatal     - bad index, unsupported, no privileges; retrying can't help
+// Retries back off exponentially with jitter and stop when the operation's time budget
+// would be exceeded, so a burst of failures can't stall the caller.
+
+enum class DdcErrorClass { none = 0, transient = 1, busy = 2, mismatch = 3, fatal = 4 };
+
+DdcErrorClass ClassifyDdcError(int rc);
+const char* DdcErrorClassName(DdcErrorClass c);
+
+struct DdcRetryPolicy {
+    unsigned int budgetMs = 250;          // from the first attempt to the start of the last
+    unsigned int initialBackoffMs = 8;
+    unsigned int maxBackoffMs = 120;
+    int maxAttempts = 6;
+};
+
+struct DdcAttempt {
+    int rc = 0;
+    DdcErrorClass cls = DdcErrorClass::none;
+    unsigned int startMs = 0;     // since the first attempt
+    unsigned int durationMs = 0;
+    unsigned int backoffMs = 0;   // slept after this attempt
+};
+
+struct DdcRetryOutcome {
+    int rc = 0;                   // status of the last attempt
+    DdcErrorClass cls = DdcErrorClass::none;
+    unsigned int elapsedMs = 0;
+    bool budgetExhausted = false; // stopped for time or attempts, not because it was fatal
+    std::vector<DdcAttempt> attempts;
+};
+
+// Runs op until it returns 0, fails fatally, or the policy runs out.
+DdcRetryOutcome RunWithRetry(const DdcRetryPolicy& policy, const std::function<int()>& op);
+
+// Process-wide counters, for diagnostics. RecordDdcRetry also publishes the totals as
+// metrics gauges (retryOperations, retryAttempts, retryRecovered, retryExhausted, retryFatal).
+struct DdcRetryStats {
+    unsigned long long operations = 0;
+    unsigned long long attempts = 0;
+    unsigned long long recovered = 0;  // succeeded after at least one failed attempt
+    unsigned long long exhausted = 0;  // gave up on a retryable error
+    unsigned long long fatal = 0;
+    unsigned long long byClass[5] = {}; // failed attempts, indexed by DdcErrorClass
+};
+
+void RecordDdcRetry(const DdcRetryOutcome& outcome);
+DdcRetryStats GetDdcRetryStats();
+
+#endif // !DDC_RETRY_H
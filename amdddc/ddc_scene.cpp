@@ -0,0 +1,36 @@
+#include "ddc_scene.h"
+#include "ddc_coalesce.h"
+#include <chrono>
+
+using Clock = std::chrono::steady_clock;
+
+static unsigned int MsSince(Clock::time_point t)
+{
+    return (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - t).count();
+}
+
+int RunDdcScene(int adapterIdx, int displayIdx, const DdcScene& scene, DdcSceneResult& out)
+{
+    out = DdcSceneResult();
+    const Clock::time_point begin = Clock::now();
+
+    out.valueRc.reserve(scene.values.size());
+    for (const auto& v : scene.values) {
+        int rc = SetVcpValueWithI2cAddr(adapterIdx, displayIdx, v.code, v.value, scene.valueSubaddress);
+        out.valueRc.push_back(rc);
+        if (rc == 0)
+            NoteVcpValue(adapterIdx, displayIdx, scene.valueSubaddress, v.code, v.value);
+        else if (out.rc == 0)
+            out.rc = rc;
+    }
+    out.valuesMs = MsSince(begin);
+
+    if (scene.hasInput) {
+        int rc = SetVcpFeatureWithI2cAddrEx(adapterIdx, displayIdx, scene.inputCode, scene.inputValue,
+            scene.inputSubaddress, scene.settleDeadlineMs, &out.input);
+        if (rc != 0 && out.rc == 0) out.rc = rc;
+    }
+
+    out.totalMs = MsSince(begin);
+    return out.rc;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef DDC_SCENE_H
+#define DDC_SCENE_H
+
+#include "amdddc_core.h"
+#include <vector>
+
+// A scene: several VCP writes to one display as a single action, e.g. "laptop" =
+// brightness 60, volume 20, input USB-C.
+//
+// The plain values go out back to back, spaced only by the bus scheduler's minimum gap
+// (ddc_bus.h), with no readback. The input goes last and is the only write that waits
+// for the monitor to confirm: while a monitor re-syncs to a new input it often NAKs
+// DDC/CI, so values written after the switch would mostly cost retries.
+
+struct DdcSceneValue {
+    unsigned char code = 0;
+    unsigned int value = 0;
+};
+
+struct DdcScene {
+    std::vector<DdcSceneValue> values;   // written in order
+    unsigned int valueSubaddress = 0x51;
+    bool hasInput = false;
+    unsigned char inputCode = 0xF4;
+    unsigned int inputValue = 0;
+    unsigned int inputSubaddress = 0x50;
+    unsigned int settleDeadlineMs = 700;
+};
+
+struct DdcSceneResult {
+    int rc = 0;                   // first failure; 0 when every write went through
+    std::vector<int> valueRc;     // one per DdcScene::values entry
+    DdcSwitchResult input{};      // the input write and its settle (zero when there is none)
+    unsigned int valuesMs = 0;    // time spent on the plain values
+    unsigned int totalMs = 0;     // first write -> input confirmed (or the last write)
+};
+
+// Runs the whole scene on {adapterIdx, displayIdx}. A failed value doesn't stop the rest.
+int RunDdcScene(int adapterIdx, int displayIdx, const DdcScene& scene, DdcSceneResult& out);
+
+#endif // !DDC_SCENE_H
@@ -0,0 +1,520 @@
+#include "ddc_server.h"
+#include "amdddc_core.h"
+#include "ddc_metrics.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// A client can't hold a display for longer than this with one switch
+static const std::uint32_t DDC_SERVER_MAX_DEADLINE_MS = 30000;
+
+static std::atomic<bool> g_stop{ false };
+static std::mutex g_endpointLock;
+static std::string g_endpoint;      // being served, for StopDdcServer
+#ifndef _WIN32
+static int g_listenFd = -1;         // guarded by g_endpointLock
+#endif
+
+#ifdef _WIN32
+std::string DefaultDdcServerEndpoint()
+{
+    return "\\\\.\\pipe\\amdddc";
+}
+#else
+// Where the socket goes when there is no XDG_RUNTIME_DIR: a directory of our own, since
+// /tmp is shared and world-writable
+static std::string FallbackEndpointDir()
+{
+    return "/tmp/amdddc-" + std::to_string((unsigned long)getuid());
+}
+
+std::string DefaultDdcServerEndpoint()
+{
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && runtimeDir[0] == '/') return std::string(runtimeDir) + "/amdddc.sock";
+    return FallbackEndpointDir() + "/amdddc.sock";
+}
+#endif
+
+// ---------- Requests ----------
+
+void HandleDdcServerRequest(const DdcServerRequest& req, DdcServerReply& reply, std::string& text)
+{
+    reply = DdcServerReply{};
+    reply.op = req.op;
+    text.clear();
+
+    switch ((DdcServerOp)req.op) {
+    case DdcServerOp::ping:
+        break;
+    case DdcServerOp::switchInput: {
+        DdcSwitchResult res{};
+        const std::uint32_t deadline = req.deadlineMs < DDC_SERVER_MAX_DEADLINE_MS ? req.deadlineMs : DDC_SERVER_MAX_DEADLINE_MS;
+        reply.rc = SetVcpFeatureWithI2cAddrEx(req.adapterIdx, req.displayIdx, req.vcpCode, req.value, req.i2cSubaddress,
+            deadline, &res);
+        reply.flags = (std::uint8_t)((res.confirmed ? DDC_SERVER_CONFIRMED : 0) | (res.alreadyActive ? DDC_SERVER_ALREADY_ACTIVE : 0));
+        reply.attempts = (std::uint8_t)(res.attempts < 255 ? res.attempts : 255);
+        reply.polls = (std::uint8_t)(res.polls < 255 ? res.polls : 255);
+        reply.latencyMs = res.latencyMs;
+        break;
+    }
+    case DdcServerOp::setValue:
+        reply.rc = SetVcpValueWithI2cAddr(req.adapterIdx, req.displayIdx, req.vcpCode, req.value, req.i2cSubaddress);
+        break;
+    case DdcServerOp::getValue: {
+        unsigned int cur = 0, max = 0;
+        reply.rc = GetVcpFeatureWithI2cAddr(req.adapterIdx, req.displayIdx, req.vcpCode, req.i2cSubaddress, &cur, &max);
+        reply.cur = cur;
+        reply.max = max;
+        break;
+    }
+    case DdcServerOp::stats:
+        text = DdcMetricsToJson(SnapshotDdcMetrics());
+        break;
+    default:
+        reply.rc = ADL_ERR_NOT_SUPPORTED;
+    }
+}
+
+// ---------- Connections ----------
+
+#ifdef _WIN32
+typedef HANDLE Conn;
+
+static bool ReadFull(HANDLE h, void* data, std::uint32_t len)
+{
+    char* p = (char*)data;
+    while (len) {
+        DWORD n = 0;
+        if (!ReadFile(h, p, len, &n, nullptr) || n == 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool WriteFull(HANDLE h, const void* data, std::uint32_t len)
+{
+    const char* p = (const char*)data;
+    while (len) {
+        DWORD n = 0;
+        if (!WriteFile(h, p, len, &n, nullptr) || n == 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static void CloseConn(HANDLE h)
+{
+    DisconnectNamedPipe(h);
+    CloseHandle(h);
+}
+#else
+typedef int Conn;
+
+static bool ReadFull(int fd, void* data, std::uint32_t len)
+{
+    char* p = (char*)data;
+    while (len) {
+        const ssize_t n = recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= (std::uint32_t)n;
+    }
+    return true;
+}
+
+static bool WriteFull(int fd, const void* data, std::uint32_t len)
+{
+    const char* p = (const char*)data;
+    while (len) {
+        const ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= (std::uint32_t)n;
+    }
+    return true;
+}
+
+static void CloseConn(int fd)
+{
+    close(fd);
+}
+#endif
+
+// Every connection thread, so the server can cap them and stop them. A thread marks its
+// entry done (and closes its end) as it exits; the accept loop joins and drops done entries.
+struct Connection {
+    Conn conn;
+    std::thread thread;
+    bool done = false;
+};
+
+static std::mutex g_connLock;                 // guards g_conns
+static std::condition_variable g_connFreed;   // a connection ended, or the server is stopping
+static std::list<Connection> g_conns;
+
+static void ServeConnection(Connection* self);
+
+// Ends a connection's blocking read; its thread then closes it. Caller holds g_connLock.
+static void WakeConnLocked(Connection& c)
+{
+#ifdef _WIN32
+    // Cancels only this pipe's I/O: the thread may be inside an ADL call for a request
+    DisconnectNamedPipe(c.conn);
+    CancelIoEx(c.conn, nullptr);
+#else
+    shutdown(c.conn, SHUT_RDWR);
+#endif
+}
+
+static void ReapConnectionsLocked()
+{
+    for (auto it = g_conns.begin(); it != g_conns.end();) {
+        if (!it->done) {
+            ++it;
+            continue;
+        }
+        it->thread.join(); // already past its last use of g_connLock
+        it = g_conns.erase(it);
+    }
+}
+
+// Blocks while DDC_SERVER_MAX_CLIENTS connections are open. False once the server stops.
+static bool WaitForConnectionSlot()
+{
+    std::unique_lock<std::mutex> lock(g_connLock);
+    g_connFreed.wait(lock, [] {
+        ReapConnectionsLocked();
+        return g_stop.load() || g_conns.size() < DDC_SERVER_MAX_CLIENTS;
+    });
+    return !g_stop.load();
+}
+
+static void StartConnection(Conn c)
+{
+    std::lock_guard<std::mutex> lock(g_connLock);
+    g_conns.emplace_back();
+    Connection& entry = g_conns.back();
+    entry.conn = c;
+    entry.thread = std::thread(ServeConnection, &entry);
+}
+
+// Wakes every connection and waits for the threads; requests in progress finish first
+static void StopConnections()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_connLock);
+        for (auto& c : g_conns)
+            if (!c.done) WakeConnLocked(c);
+    }
+    // Only this thread adds or erases entries, so the list is stable without the lock
+    for (auto& c : g_conns) c.thread.join();
+    std::lock_guard<std::mutex> lock(g_connLock);
+    g_conns.clear();
+}
+
+// One client, until it disconnects or sends something that isn't a request
+static void ServeConnection(Connection* self)
+{
+    const Conn c = self->conn;
+    std::vector<char> frame;
+    for (;;) {
+        std::uint32_t len = 0;
+        DdcServerRequest req;
+        if (!ReadFull(c, &len, sizeof(len)) || len != sizeof(req) || !ReadFull(c, &req, sizeof(req))) break;
+
+        DdcServerReply reply;
+        std::string text;
+        HandleDdcServerRequest(req, reply, text);
+        if (text.size() > DDC_SERVER_MAX_FRAME - sizeof(reply)) text.resize(DDC_SERVER_MAX_FRAME - sizeof(reply));
+        reply.textLen = (std::uint32_t)text.size();
+
+        // Length, reply and text in one write
+        const std::uint32_t body = (std::uint32_t)(sizeof(reply) + text.size());
+        frame.resize(sizeof(body) + body);
+        std::memcpy(frame.data(), &body, sizeof(body));
+        std::memcpy(frame.data() + sizeof(body), &reply, sizeof(reply));
+        if (!text.empty()) std::memcpy(frame.data() + sizeof(body) + sizeof(reply), text.data(), text.size());
+        if (!WriteFull(c, frame.data(), (std::uint32_t)frame.size())) break;
+    }
+
+    // Closed under the lock, so StopConnections never wakes a handle that's been reused
+    std::lock_guard<std::mutex> lock(g_connLock);
+    CloseConn(c);
+    self->done = true;
+    g_connFreed.notify_all();
+}
+
+// ---------- Server ----------
+
+#ifdef _WIN32
+bool RunDdcServer(const std::string& endpoint, std::string* error)
+{
+    g_stop.store(false);
+    {
+        std::lock_guard<std::mutex> lock(g_endpointLock);
+        g_endpoint = endpoint;
+    }
+
+    // One pipe instance per client: create, wait for a connection, hand it to a thread, repeat
+    bool first = true;
+    while (WaitForConnectionSlot()) {
+        HANDLE pipe = CreateNamedPipeA(endpoint.c_str(), PIPE_ACCESS_DUPLEX | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, PIPE_UNLIMITED_INSTANCES,
+            4096, 4096, 0, nullptr);
+        if (pipe == INVALID_HANDLE_VALUE) {
+            if (error) *error = first ? "could not create " + endpoint + " (is a server already running?)" : "could not create another pipe instance";
+            StopConnections();
+            return false;
+        }
+        first = false;
+
+        const bool connected = ConnectNamedPipe(pipe, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+        if (g_stop.load() || !connected) {
+            CloseHandle(pipe);
+            continue;
+        }
+        StartConnection(pipe);
+    }
+    StopConnections();
+    return true;
+}
+
+void StopDdcServer()
+{
+    g_stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(g_connLock);
+        g_connFreed.notify_all();
+    }
+    std::string endpoint;
+    {
+        std::lock_guard<std::mutex> lock(g_endpointLock);
+        endpoint = g_endpoint;
+    }
+    // Wakes the ConnectNamedPipe the server is blocked in
+    HANDLE h = CreateFileA(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (h != INVALID_HANDLE_VALUE) CloseHandle(h);
+}
+#else
+static bool FillAddress(const std::string& endpoint, sockaddr_un& addr, std::string* error)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (endpoint.empty() || endpoint.size() >= sizeof(addr.sun_path)) {
+        if (error) *error = "socket path '" + endpoint + "' is empty or too long";
+        return false;
+    }
+    std::memcpy(addr.sun_path, endpoint.c_str(), endpoint.size());
+    return true;
+}
+
+// dir exists, is ours and nobody else can get in; created mode 0700 if missing
+static bool EnsurePrivateDir(const std::string& dir, std::string* error)
+{
+    if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        if (error) *error = "could not create " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077) != 0) {
+        if (error) *error = dir + " is not a private directory owned by this user";
+        return false;
+    }
+    return true;
+}
+
+bool RunDdcServer(const std::string& endpoint, std::string* error)
+{
+    sockaddr_un addr;
+    if (!FillAddress(endpoint, addr, error)) return false;
+    const std::string fallbackDir = FallbackEndpointDir();
+    if (endpoint.compare(0, fallbackDir.size() + 1, fallbackDir + "/") == 0 && !EnsurePrivateDir(fallbackDir, error))
+        return false;
+
+    // A socket file nobody answers on is left over from a crashed server
+    DdcServerClient probe;
+    if (probe.Connect(endpoint)) {
+        if (error) *error = "a server is already running on " + endpoint;
+        return false;
+    }
+    unlink(endpoint.c_str());
+
+    // The socket file is created 0600 by bind itself: a chmod afterwards would leave a window
+    // in which anyone could connect. umask is process-wide, but nothing else creates files
+    // while the server starts.
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    const mode_t oldMask = umask(0177);
+    const bool bound = fd >= 0 && bind(fd, (const sockaddr*)&addr, sizeof(addr)) == 0;
+    const int bindErrno = errno;
+    umask(oldMask);
+    if (!bound || listen(fd, SOMAXCONN) != 0) {
+        if (error) *error = "could not listen on " + endpoint + ": " + std::strerror(bound ? errno : bindErrno);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    g_stop.store(false);
+    {
+        std::lock_guard<std::mutex> lock(g_endpointLock);
+        g_endpoint = endpoint;
+        g_listenFd = fd;
+    }
+    while (WaitForConnectionSlot()) {
+        const int c = accept(fd, nullptr, nullptr);
+        if (c < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        StartConnection(c);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_endpointLock);
+        g_listenFd = -1;
+    }
+    close(fd);
+    unlink(endpoint.c_str());
+    StopConnections();
+    return true;
+}
+
+void StopDdcServer()
+{
+    g_stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(g_connLock);
+        g_connFreed.notify_all();
+    }
+    // Wakes the accept the server is blocked in
+    std::lock_guard<std::mutex> lock(g_endpointLock);
+    if (g_listenFd >= 0) shutdown(g_listenFd, SHUT_RDWR);
+}
+#endif
+
+// ---------- Client ----------
+
+#ifdef _WIN32
+bool DdcServerClient::Connect(const std::string& endpoint, std::string* error)
+{
+    Close();
+    for (int tries = 0; ; ++tries) {
+        HANDLE h = CreateFileA(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (h != INVALID_HANDLE_VALUE) {
+            m_pipe = h;
+            return true;
+        }
+        // Every instance busy: the server creates the next one as soon as it hands this one off
+        if (GetLastError() != ERROR_PIPE_BUSY || tries == 2 || !WaitNamedPipeA(endpoint.c_str(), 2000)) {
+            if (error) *error = "no server on " + endpoint;
+            return false;
+        }
+    }
+}
+
+bool DdcServerClient::Connected() const
+{
+    return m_pipe != nullptr;
+}
+
+void DdcServerClient::Close()
+{
+    if (m_pipe) CloseHandle((HANDLE)m_pipe);
+    m_pipe = nullptr;
+}
+
+bool DdcServerClient::SendAll(const void* data, std::uint32_t len)
+{
+    return WriteFull((HANDLE)m_pipe, data, len);
+}
+
+bool DdcServerClient::RecvAll(void* data, std::uint32_t len)
+{
+    return ReadFull((HANDLE)m_pipe, data, len);
+}
+#else
+bool DdcServerClient::Connect(const std::string& endpoint, std::string* error)
+{
+    Close();
+    sockaddr_un addr;
+    if (!FillAddress(endpoint, addr, error)) return false;
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (const sockaddr*)&addr, sizeof(addr)) != 0) {
+        if (error) *error = "no server on " + endpoint;
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    m_fd = fd;
+    return true;
+}
+
+bool DdcServerClient::Connected() const
+{
+    return m_fd >= 0;
+}
+
+void DdcServerClient::Close()
+{
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+}
+
+bool DdcServerClient::SendAll(const void* data, std::uint32_t len)
+{
+    return WriteFull(m_fd, data, len);
+}
+
+bool DdcServerClient::RecvAll(void* data, std::uint32_t len)
+{
+    return ReadFull(m_fd, data, len);
+}
+#endif
+
+bool DdcServerClient::Call(const DdcServerRequest& req, DdcServerReply& reply, std::string* text)
+{
+    if (!Connected()) return false;
+
+    char frame[sizeof(std::uint32_t) + sizeof(DdcServerRequest)];
+    const std::uint32_t len = sizeof(DdcServerRequest);
+    std::memcpy(frame, &len, sizeof(len));
+    std::memcpy(frame + sizeof(len), &req, sizeof(req));
+
+    std::uint32_t body = 0;
+    if (!SendAll(frame, sizeof(frame)) || !RecvAll(&body, sizeof(body)) ||
+        body < sizeof(reply) || body > DDC_SERVER_MAX_FRAME || !RecvAll(&reply, sizeof(reply)) ||
+        reply.textLen != body - sizeof(reply)) {
+        Close();
+        return false;
+    }
+
+    std::string received(reply.textLen, '\0');
+    if (reply.textLen && !RecvAll(&received[0], reply.textLen)) {
+        Close();
+        return false;
+    }
+    if (text) *text = std::move(received);
+    return true;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#ifndef DDC_SERVER_H
+#define DDC_SERVER_H
+
+#include <cstdint>
+#include <string>
+
+// Long-running switch daemon (amdddc-windows serve) and its client.
+//
+// One process keeps the transport open (ADL loaded, context created) and answers requests
+// over a local endpoint: a named pipe on Windows (\\.\pipe\amdddc), a Unix domain socket
+// elsewhere (DefaultDdcServerEndpoint). Each client connection gets its own thread, so
+// several clients switch at once; the bus scheduler (ddc_bus.h) still serializes per
+// display. Past DDC_SERVER_MAX_CLIENTS, new clients wait until one disconnects.
+//
+// Protocol: every message is a 4-byte body length followed by the body. A request body is
+// one DdcServerRequest; a reply body is one DdcServerReply followed by textLen bytes of
+// text (the metrics JSON for stats). Integers are in host byte order: both ends are on the
+// same machine. A frame of an unexpected size closes the connection.
+
+#define DDC_SERVER_MAX_FRAME    (1 << 20)  // largest body either side accepts
+#define DDC_SERVER_MAX_CLIENTS  16         // connections served at once
+
+// \\.\pipe\amdddc on Windows. Elsewhere $XDG_RUNTIME_DIR/amdddc.sock, or without that
+// /tmp/amdddc-<uid>/amdddc.sock, in a directory RunDdcServer creates mode 0700.
+std::string DefaultDdcServerEndpoint();
+
+enum class DdcServerOp : std::uint8_t {
+    ping = 0,       // no bus traffic; measures the channel
+    switchInput,    // SetVcpFeatureWithI2cAddrEx: write, then read back until it sticks
+    setValue,       // SetVcpValueWithI2cAddr: write with retries, no readback
+    getValue,       // GetVcpFeatureWithI2cAddr
+    stats           // DdcMetricsToJson of the server's metrics
+};
+
+#pragma pack(push, 1)
+struct DdcServerRequest {
+    std::uint8_t op;            // DdcServerOp
+    std::uint8_t vcpCode;
+    std::uint8_t i2cSubaddress;
+    std::uint8_t reserved;
+    std::int16_t adapterIdx;
+    std::int16_t displayIdx;
+    std::uint32_t value;        // switchInput / setValue
+    std::uint32_t deadlineMs;   // switchInput: settle deadline
+};
+
+#define DDC_SERVER_CONFIRMED       0x01  // switchInput: the monitor read back the new value
+#define DDC_SERVER_ALREADY_ACTIVE  0x02  // switchInput: it was already there, nothing written
+
+struct DdcServerReply {
+    std::uint8_t op;            // echoes the request
+    std::uint8_t flags;         // DDC_SERVER_*
+    std::uint8_t attempts;      // switchInput: writes made
+    std::uint8_t polls;         // switchInput: readbacks spent confirming
+    std::int32_t rc;            // 0, an ADL code or a DDC_ERR_* code
+    std::uint32_t cur;          // getValue
+    std::uint32_t max;          // getValue
+    std::uint32_t latencyMs;    // switchInput: write to confirmation (or deadline)
+    std::uint32_t textLen;      // bytes of text after the reply
+};
+#pragma pack(pop)
+
+static_assert(sizeof(DdcServerRequest) == 16, "request layout is part of the protocol");
+static_assert(sizeof(DdcServerReply) == 24, "reply layout is part of the protocol");
+
+// Runs one request against the active transport. What a connection thread does per frame.
+void HandleDdcServerRequest(const DdcServerRequest& req, DdcServerReply& reply, std::string& text);
+
+// Serves endpoint until StopDdcServer, which also ends the open connections (a request in
+// progress finishes first). Returns false (with error) if the endpoint can't be created; a
+// stale Unix socket left by a crashed server is replaced. The socket is only accessible to
+// the user running the server.
+bool RunDdcServer(const std::string& endpoint, std::string* error = nullptr);
+void StopDdcServer();
+
+// One connection to a server; requests on it are answered in order. Not thread-safe: use
+// one client per thread.
+class DdcServerClient {
+public:
+    DdcServerClient() = default;
+    ~DdcServerClient() { Close(); }
+    DdcServerClient(const DdcServerClient&) = delete;
+    DdcServerClient& operator=(const DdcServerClient&) = delete;
+
+    bool Connect(const std::string& endpoint, std::string* error = nullptr);
+    bool Connected() const;
+    void Close();
+
+    // False if the connection failed; the request's own status is reply.rc. text may be null.
+    bool Call(const DdcServerRequest& req, DdcServerReply& reply, std::string* text = nullptr);
+
+private:
+    bool SendAll(const void* data, std::uint32_t len);
+    bool RecvAll(void* data, std::uint32_t len);
+
+#ifdef _WIN32
+    void* m_pipe = nullptr;     // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
+
+#endif // !DDC_SERVER_H
@@ -0,0 +1,47 @@
+#include "ddc_settle.h"
+#include "ddc_reply.h"
+#include "ddc_transport.h"
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static unsigned int MsSince(Clock::time_point t)
+{
+    return (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - t).count();
+}
+
+DdcSettleResult WaitForVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress,
+    unsigned char vcpCode, unsigned int value,
+    Clock::time_point writtenAt, unsigned int deadlineMs, unsigned int firstPollMs)
+{
+    DdcSettleResult res;
+    const Clock::time_point deadline = writtenAt + std::chrono::milliseconds(deadlineMs);
+
+    // The bus scheduler already keeps polls the DDC/CI gap apart; this only holds the first
+    // one back until the monitor is likely to have switched
+    const Clock::time_point firstPoll = writtenAt + std::chrono::milliseconds(firstPollMs);
+    std::this_thread::sleep_until(firstPoll < deadline ? firstPoll : deadline);
+
+    while (Clock::now() < deadline) {
+        VcpReply reply;
+        int rc = GetVcpFeature(adapterIdx, displayIdx, subaddress, vcpCode, reply);
+        ++res.polls;
+        res.lastRc = rc;
+        if (rc == 0) res.lastValue = reply.cur;
+
+        if (rc == 0 && reply.cur == (value & 0xFFFF)) {
+            res.confirmed = true;
+            res.elapsedMs = MsSince(writtenAt);
+            return res;
+        }
+        if (rc == DDC_ERR_UNSUPPORTED_VCP) {
+            res.unsupported = true;
+            break;
+        }
+    }
+
+    // No confirmation possible: give the monitor the rest of its budget, as before
+    std::this_thread::sleep_until(deadline);
+    res.elapsedMs = MsSince(writtenAt);
+    return res;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef DDC_SETTLE_H
+#define DDC_SETTLE_H
+
+#include <chrono>
+
+// Settle detection for input switches: instead of sleeping a fixed time after the
+// write, poll the monitor with Get VCP Feature until it reports the new value.
+
+struct DdcSettleResult {
+    bool confirmed = false;     // monitor read back the requested value
+    unsigned int elapsedMs = 0; // from the write to confirmation (or to the deadline)
+    int polls = 0;              // Get VCP requests issued
+    bool unsupported = false;   // monitor answered "unsupported VCP code" to the poll
+    int lastRc = -1;            // status of the last poll (0 = it read back lastValue)
+    unsigned int lastValue = 0;
+};
+
+// Polls vcpCode on {adapterIdx, displayIdx} via the given subaddress until it reads back
+// `value`. `writtenAt` is when the write went out; the deadline and the reported latency
+// are both measured from it. The first poll goes out firstPollMs after the write, later
+// ones as soon as the bus allows (ddc_bus.h). Monitors that can't read the code back make
+// this wait out the deadline, like the old fixed sleep.
+DdcSettleResult WaitForVcpValue(int adapterIdx, int displayIdx, unsigned int subaddress,
+    unsigned char vcpCode, unsigned int value,
+    std::chrono::steady_clock::time_point writtenAt, unsigned int deadlineMs,
+    unsigned int firstPollMs = 0);
+
+#endif // !DDC_SETTLE_H
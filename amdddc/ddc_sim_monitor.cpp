@@ -0,0 +1,252 @@
+#include "ddc_sim_monitor.h"
+#include "ddc_caps.h"
+#include "ddc_frame.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <cstdlib>
+#include <sstream>
+
+static const char SIM_CAPS[] =
+    "(prot(monitor)type(LCD)model(SIM)cmds(01 02 03 0C E3 F3)"
+    "vcp(02 04 05 08 10 12 14(05 08 0B) 16 18 1A 52 60(0F 11 12) 62 AC AE B2 B6 C6 C8 C9 D6(01 04) DF F4)"
+    "mccs_ver(2.1))";
+
+static const unsigned char VCP_POWER = 0xD6;
+static const unsigned short POWER_ON = 1;
+
+static bool IsInputCode(unsigned char code)
+{
+    return code == 0x60 || code == 0xF4;
+}
+
+// ---------- Model spec ----------
+
+bool ParseSimMonitorModel(const std::string& spec, DdcSimMonitorModel& out, std::string* error)
+{
+    DdcSimMonitorModel m = out;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        const std::size_t eq = item.find('=');
+        const std::string key = item.substr(0, eq);
+        const std::string val = eq == std::string::npos ? std::string() : item.substr(eq + 1);
+        char* end = nullptr;
+        const double v = std::strtod(val.c_str(), &end);
+        if (val.empty() || *end != '\0' || v < 0 || v > 4e9) {
+            if (error) *error = "bad value in '" + item + "'";
+            return false;
+        }
+
+        if (key == "switch") m.switchMs = (unsigned int)v;
+        else if (key == "jitter") m.switchJitterMs = (unsigned int)v;
+        else if (key == "busy") m.busyMs = (unsigned int)v;
+        else if (key == "wake") m.wakeMs = (unsigned int)v;
+        else if (key == "seed") m.seed = (unsigned int)v;
+        else if (key == "nak" || key == "corrupt") {
+            if (v > 1) {
+                if (error) *error = key + " is a rate between 0 and 1";
+                return false;
+            }
+            (key == "nak" ? m.nakRate : m.corruptRate) = v;
+        }
+        else {
+            if (error) *error = "unknown key '" + key + "'";
+            return false;
+        }
+    }
+    out = m;
+    return true;
+}
+
+// ---------- Monitor ----------
+
+DdcSimMonitor::DdcSimMonitor(const DdcSimMonitorModel& model, unsigned int salt)
+    : m_model(model), m_rng(model.seed * 2654435761u ^ salt)
+{
+    DdcCapabilities caps;
+    ParseCapabilities(SIM_CAPS, caps);
+    for (const auto& kv : caps.vcp) m_vcp[kv.first] = Vcp();
+
+    // Power-on state: DP1 selected, mid brightness
+    m_vcp[0x10] = { 50, 100 };
+    m_vcp[0x12] = { 70, 100 };
+    m_vcp[0x62] = { 30, 100 };
+    m_vcp[0x60].cur = 0x0F;
+    m_vcp[0xF4].cur = 0xD0;
+    m_vcp[VCP_POWER] = { POWER_ON, 5 };
+}
+
+// Makes a pending input change visible once it's due
+void DdcSimMonitor::Advance(Clock::time_point now)
+{
+    if (m_pending && now >= m_pendingReadyAt) {
+        m_vcp[m_pendingCode].cur = m_pendingValue;
+        m_pending = false;
+    }
+}
+
+bool DdcSimMonitor::Roll(double rate)
+{
+    return rate > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < rate;
+}
+
+// Address, length byte (0x80 | payload bytes) and XOR checksum, as a monitor checks them
+static bool ValidFrame(const unsigned char* frame, int len)
+{
+    if (!frame || len < 4 || frame[0] != DDC_DEST_ADDR) return false;
+    if ((frame[2] & 0x80) == 0 || (frame[2] & 0x7F) + 4 != len) return false;
+    return DdcChecksum(frame, (std::size_t)(len - 1)) == frame[len - 1];
+}
+
+int DdcSimMonitor::Write(const unsigned char* frame, int len)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    const Clock::time_point now = Clock::now();
+    Advance(now);
+
+    if (!ValidFrame(frame, len)) {
+        ++m_stats.rejected;
+        return ADL_ERR;
+    }
+    if (now < m_busyUntil || Roll(m_model.nakRate)) {
+        ++m_stats.naks;
+        return ADL_ERR;
+    }
+
+    // Set VCP Feature: 0x03, code, value high, value low. Anything else is acknowledged and dropped.
+    if (len != 8 || frame[3] != 0x03) return ADL_OK;
+    ++m_stats.writes;
+
+    const unsigned char code = frame[4];
+    const unsigned short value = (unsigned short)((frame[5] << 8) | frame[6]);
+    auto it = m_vcp.find(code);
+    if (it == m_vcp.end()) return ADL_OK;
+
+    const bool standby = m_vcp[VCP_POWER].cur != POWER_ON;
+    if (code == VCP_POWER) {
+        if (standby && value == POWER_ON) m_busyUntil = now + std::chrono::milliseconds(m_model.wakeMs);
+        it->second.cur = value;
+        return ADL_OK;
+    }
+    if (standby) return ADL_OK;
+
+    if (!IsInputCode(code)) {
+        it->second.cur = value < it->second.max ? value : it->second.max;
+        return ADL_OK;
+    }
+
+    // Input change: the scaler re-syncs, and readback shows the new input only when it's done
+    if (!m_pending && it->second.cur == value) return ADL_OK;
+    int delayMs = (int)m_model.switchMs;
+    if (m_model.switchJitterMs) {
+        const int j = (int)m_model.switchJitterMs;
+        delayMs += std::uniform_int_distribution<int>(-j, j)(m_rng);
+        if (delayMs < 0) delayMs = 0;
+    }
+    ++m_stats.inputChanges;
+    m_busyUntil = now + std::chrono::milliseconds(m_model.busyMs);
+    if (delayMs == 0) {
+        it->second.cur = value;
+        m_pending = false;
+    } else {
+        m_pending = true;
+        m_pendingCode = code;
+        m_pendingValue = value;
+        m_pendingReadyAt = now + std::chrono::milliseconds(delayMs);
+    }
+    return ADL_OK;
+}
+
+int DdcSimMonitor::WriteRead(const unsigned char* request, int requestLen, unsigned char* reply, int* ioReplyLen)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    const Clock::time_point now = Clock::now();
+    Advance(now);
+
+    if (!reply || !ioReplyLen || !ValidFrame(request, requestLen)) {
+        ++m_stats.rejected;
+        return ADL_ERR;
+    }
+    if (Roll(m_model.nakRate)) {
+        ++m_stats.naks;
+        return ADL_ERR;
+    }
+    const bool standby = m_vcp[VCP_POWER].cur != POWER_ON;
+    ++m_stats.requests;
+
+    int rc;
+    if (requestLen == 7 && request[3] == 0xF3) {
+        // Capabilities Request: 0xF3, offset hi, offset lo
+        if (now < m_busyUntil || standby) return NullReply(reply, ioReplyLen);
+        rc = CapabilitiesReply((unsigned int)((request[4] << 8) | request[5]), reply, ioReplyLen);
+    } else if (requestLen == 6 && request[3] == 0x01 && *ioReplyLen >= 11) {
+        // Get VCP Feature: 0x01, code
+        const unsigned char code = request[4];
+        if (now < m_busyUntil || (standby && code != VCP_POWER)) return NullReply(reply, ioReplyLen);
+
+        auto it = m_vcp.find(code);
+        const Vcp v = it == m_vcp.end() ? Vcp{ 0, 0 } : it->second;
+        // Get VCP Feature Reply: 0x6E, 0x88, 0x02, result, code, type, max hi/lo, cur hi/lo, checksum
+        unsigned char r[11] = { 0x6E, 0x88, 0x02, (unsigned char)(it == m_vcp.end() ? 0x01 : 0x00), code, 0x00,
+                                (unsigned char)(v.max >> 8), (unsigned char)(v.max & 0xFF),
+                                (unsigned char)(v.cur >> 8), (unsigned char)(v.cur & 0xFF), 0x00 };
+        r[10] = DdcChecksum(r, 10, DDC_HOST_ADDR); // replies are checksummed from the host's virtual address
+        for (int i = 0; i < 11; ++i) reply[i] = r[i];
+        *ioReplyLen = 11;
+        rc = ADL_OK;
+    } else {
+        return ADL_ERR;
+    }
+
+    if (rc == ADL_OK && Roll(m_model.corruptRate)) {
+        reply[*ioReplyLen - 1] ^= 0x5A;
+        ++m_stats.corrupted;
+    }
+    return rc;
+}
+
+bool DdcSimMonitor::Peek(unsigned char code, unsigned short& cur)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    Advance(Clock::now());
+    auto it = m_vcp.find(code);
+    if (it == m_vcp.end()) return false;
+    cur = it->second.cur;
+    return true;
+}
+
+DdcSimMonitorStats DdcSimMonitor::Stats()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_stats;
+}
+
+// Null message: 0x6E, 0x80, checksum. Called with m_lock held.
+int DdcSimMonitor::NullReply(unsigned char* reply, int* ioReplyLen)
+{
+    if (*ioReplyLen < 3) return ADL_ERR;
+    reply[0] = 0x6E;
+    reply[1] = 0x80;
+    reply[2] = DdcChecksum(reply, 2, DDC_HOST_ADDR);
+    *ioReplyLen = 3;
+    return ADL_OK;
+}
+
+// Capabilities Reply: 0x6E, 0x80 | (3 + n), 0xE3, offset hi/lo, n data bytes, checksum
+int DdcSimMonitor::CapabilitiesReply(unsigned int offset, unsigned char* reply, int* ioReplyLen)
+{
+    const unsigned int total = (unsigned int)sizeof(SIM_CAPS) - 1;
+
+    const unsigned int n = offset >= total ? 0 : (total - offset < 32 ? total - offset : 32);
+    if (*ioReplyLen < (int)n + 6) return ADL_ERR;
+
+    reply[0] = 0x6E;
+    reply[1] = (unsigned char)(0x80 | (3 + n));
+    reply[2] = 0xE3;
+    reply[3] = (unsigned char)(offset >> 8);
+    reply[4] = (unsigned char)(offset & 0xFF);
+    for (unsigned int i = 0; i < n; ++i) reply[5 + i] = (unsigned char)SIM_CAPS[offset + i];
+    reply[5 + n] = DdcChecksum(reply, 5 + n, DDC_HOST_ADDR);
+    *ioReplyLen = (int)n + 6;
+    return ADL_OK;
+}
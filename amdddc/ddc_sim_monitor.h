@@ -0,0 +1,88 @@
+#pragma once
+#ifndef DDC_SIM_MONITOR_H
+#define DDC_SIM_MONITOR_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+
+// One simulated DDC/CI monitor: what the sim transport (and through it the ADL mock) talks to.
+//
+// It takes frames exactly as the host puts them on the wire (ddc_frame.h), checks address,
+// length byte and checksum the way a scaler does, and keeps VCP state: input (0x60, and 0xF4
+// on LG's side channel), brightness 0x10, contrast 0x12, volume 0x62 and power 0xD6.
+// Codes missing from its capabilities string answer "unsupported". Timing follows
+// DdcSimMonitorModel:
+//   - an input change shows on readback switchMs (+/- switchJitterMs) after the write
+//   - for busyMs after an input change the scaler is re-syncing: requests get the null
+//     message and writes are not acknowledged
+//   - in standby (0xD6 != 1) only the power code answers and other writes are ignored;
+//     waking up (0xD6 = 1) is busy for wakeMs
+//   - nakRate / corruptRate drop acknowledgements and damage reply checksums at random
+
+struct DdcSimMonitorModel {
+    unsigned int switchMs = 0;
+    unsigned int switchJitterMs = 0;
+    unsigned int busyMs = 0;
+    unsigned int wakeMs = 0;
+    double nakRate = 0.0;      // 0..1, per message
+    double corruptRate = 0.0;  // 0..1, per reply
+    unsigned int seed = 1;     // jitter and injected faults are reproducible per seed
+};
+
+// "switch=150,jitter=40,busy=60,wake=2000,nak=0.01,corrupt=0.005,seed=7"; keys not given keep
+// the value already in out
+bool ParseSimMonitorModel(const std::string& spec, DdcSimMonitorModel& out, std::string* error = nullptr);
+
+struct DdcSimMonitorStats {
+    unsigned long long writes = 0;       // Set VCP frames accepted
+    unsigned long long requests = 0;     // Get VCP / Capabilities requests answered
+    unsigned long long rejected = 0;     // malformed frames
+    unsigned long long naks = 0;         // injected, or busy re-syncing
+    unsigned long long nullReplies = 0;
+    unsigned long long corrupted = 0;
+    unsigned long long inputChanges = 0;
+};
+
+class DdcSimMonitor {
+public:
+    // salt tells monitors sharing a model apart (different jitter and fault sequences)
+    DdcSimMonitor(const DdcSimMonitorModel& model, unsigned int salt = 0);
+
+    // Same contract as DdcTransport::Write / WriteRead; thread-safe
+    int Write(const unsigned char* frame, int len);
+    int WriteRead(const unsigned char* request, int requestLen, unsigned char* reply, int* ioReplyLen);
+
+    // Value a Get VCP would read now (false for unsupported codes), without bus effects
+    bool Peek(unsigned char code, unsigned short& cur);
+    DdcSimMonitorStats Stats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Vcp {
+        unsigned short cur = 0;
+        unsigned short max = 0xFF;
+    };
+
+    void Advance(Clock::time_point now);
+    bool Roll(double rate);
+    static int NullReply(unsigned char* reply, int* ioReplyLen);
+    static int CapabilitiesReply(unsigned int offset, unsigned char* reply, int* ioReplyLen);
+
+    DdcSimMonitorModel m_model;
+    std::mutex m_lock;
+    std::mt19937 m_rng;
+    std::map<unsigned char, Vcp> m_vcp;        // supported codes only
+    DdcSimMonitorStats m_stats;
+
+    bool m_pending = false;                    // input change not visible yet
+    unsigned char m_pendingCode = 0;
+    unsigned short m_pendingValue = 0;
+    Clock::time_point m_pendingReadyAt;
+    Clock::time_point m_busyUntil;
+};
+
+#endif // !DDC_SIM_MONITOR_H
@@ -0,0 +1,268 @@
+#include "ddc_trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static const std::uint32_t DDC_TRACE_MAGIC = 0x54434444; // "DDCT"
+static const std::uint16_t DDC_TRACE_VERSION = 1;
+
+struct DdcTraceRecord {
+    std::atomic<std::uint64_t> seq;  // claim index + 1 once published, 0 while being written
+    std::uint64_t timeNs;
+    std::int32_t rc;
+    std::int16_t adapterIdx;
+    std::int16_t displayIdx;
+    std::uint8_t dir;
+    std::uint8_t len;                // bytes kept
+    std::uint16_t fullLen;
+    unsigned char bytes[DDC_TRACE_MAX_BYTES];
+};
+static_assert(sizeof(DdcTraceRecord) == 64, "trace records are one cache line");
+static_assert((DDC_TRACE_CAPACITY & (DDC_TRACE_CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+// File layout: this header, then DDC_TRACE_CAPACITY records
+struct DdcTraceHeader {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t recordSize;
+    std::uint32_t capacity;
+    std::uint32_t reserved0;
+    std::atomic<std::uint64_t> head; // next claim index
+    std::int64_t anchorWallMs;       // wall clock and steady clock at the same instant,
+    std::uint64_t anchorSteadyNs;    // to put record times on a calendar
+    unsigned char reserved[24];
+};
+static_assert(sizeof(DdcTraceHeader) == 64, "header is one record long");
+
+struct DdcTraceRing {
+    DdcTraceHeader header;
+    DdcTraceRecord records[DDC_TRACE_CAPACITY];
+};
+
+std::uint64_t DdcTraceNowNs()
+{
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static void InitRing(DdcTraceRing* r)
+{
+    std::memset((void*)r, 0, sizeof(DdcTraceRing));
+    r->header.magic = DDC_TRACE_MAGIC;
+    r->header.version = DDC_TRACE_VERSION;
+    r->header.recordSize = (std::uint16_t)sizeof(DdcTraceRecord);
+    r->header.capacity = DDC_TRACE_CAPACITY;
+    r->header.anchorWallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    r->header.anchorSteadyNs = DdcTraceNowNs();
+}
+
+static DdcTraceRing* MemoryRing()
+{
+    static DdcTraceRing* ring = [] {
+        auto* r = new DdcTraceRing;
+        InitRing(r);
+        return r;
+    }();
+    return ring;
+}
+
+// Swapped once to the mapped file; the memory ring stays valid for writers that loaded it before
+static std::atomic<DdcTraceRing*> g_ring{ nullptr };
+
+static DdcTraceRing* Ring()
+{
+    DdcTraceRing* r = g_ring.load(std::memory_order_acquire);
+    if (r) return r;
+    DdcTraceRing* mem = MemoryRing();
+    g_ring.compare_exchange_strong(r, mem, std::memory_order_acq_rel);
+    return g_ring.load(std::memory_order_acquire);
+}
+
+void DdcTraceFrame(int adapterIdx, int displayIdx, DdcTraceDir dir, const unsigned char* bytes, int len, int rc,
+    std::uint64_t timeNs)
+{
+    DdcTraceRing* ring = Ring();
+    const std::uint64_t idx = ring->header.head.fetch_add(1, std::memory_order_relaxed);
+    DdcTraceRecord& rec = ring->records[idx & (DDC_TRACE_CAPACITY - 1)];
+
+    // Seqlock-style publish: readers skip a slot whose sequence changes under them
+    rec.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    rec.timeNs = timeNs ? timeNs : DdcTraceNowNs();
+    rec.rc = rc;
+    rec.adapterIdx = (std::int16_t)adapterIdx;
+    rec.displayIdx = (std::int16_t)displayIdx;
+    rec.dir = (std::uint8_t)dir;
+    if (!bytes || len < 0) len = 0;
+    rec.fullLen = (std::uint16_t)len;
+    rec.len = (std::uint8_t)(len < DDC_TRACE_MAX_BYTES ? len : DDC_TRACE_MAX_BYTES);
+    if (rec.len) std::memcpy(rec.bytes, bytes, rec.len);
+    rec.seq.store(idx + 1, std::memory_order_release);
+}
+
+// ---------- File backing ----------
+
+static void* MapTraceFile(const std::string& path)
+{
+    const std::size_t size = sizeof(DdcTraceRing);
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, (DWORD)size, nullptr);
+    CloseHandle(file); // the mapping keeps the file open
+    if (!mapping) return nullptr;
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    CloseHandle(mapping); // and the view keeps the mapping
+    return view;
+#elif defined(__linux__)
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return nullptr;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return view == MAP_FAILED ? nullptr : view;
+#else
+    (void)path;
+    (void)size;
+    return nullptr;
+#endif
+}
+
+bool OpenDdcTraceFile(const std::string& path)
+{
+    // Keep the last run's trace: it is the one to look at after a crash
+    const std::string prev = path + ".prev";
+    std::remove(prev.c_str());
+    std::rename(path.c_str(), prev.c_str());
+
+    void* view = MapTraceFile(path);
+    if (!view) return false;
+    auto* ring = (DdcTraceRing*)view;
+    InitRing(ring);
+    // The mapping is never unmapped: writers may still hold the pointer until exit
+    g_ring.store(ring, std::memory_order_release);
+    return true;
+}
+
+// ---------- Reading ----------
+
+static void ReadRing(const DdcTraceRing* ring, std::vector<DdcTraceEntry>& out)
+{
+    out.clear();
+    const std::uint64_t head = ring->header.head.load(std::memory_order_acquire);
+    const std::uint64_t first = head > DDC_TRACE_CAPACITY ? head - DDC_TRACE_CAPACITY : 0;
+    out.reserve((std::size_t)(head - first));
+
+    for (std::uint64_t idx = first; idx < head; ++idx) {
+        const DdcTraceRecord& rec = ring->records[idx & (DDC_TRACE_CAPACITY - 1)];
+        const std::uint64_t s1 = rec.seq.load(std::memory_order_acquire);
+        if (s1 != idx + 1) continue; // not published yet, or already overwritten
+
+        DdcTraceEntry e;
+        e.seq = s1;
+        e.timeNs = rec.timeNs;
+        e.adapterIdx = rec.adapterIdx;
+        e.displayIdx = rec.displayIdx;
+        e.rc = rec.rc;
+        e.dir = (DdcTraceDir)rec.dir;
+        e.fullLen = rec.fullLen;
+        const unsigned int n = rec.len < DDC_TRACE_MAX_BYTES ? rec.len : DDC_TRACE_MAX_BYTES;
+        e.bytes.assign(rec.bytes, rec.bytes + n);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (rec.seq.load(std::memory_order_relaxed) != s1) continue; // rewritten while copying
+
+        e.wallMs = ring->header.anchorWallMs +
+            ((long long)e.timeNs - (long long)ring->header.anchorSteadyNs) / 1000000;
+        out.push_back(std::move(e));
+    }
+}
+
+std::vector<DdcTraceEntry> SnapshotDdcTrace()
+{
+    std::vector<DdcTraceEntry> out;
+    ReadRing(Ring(), out);
+    return out;
+}
+
+bool ReadDdcTraceFile(const std::string& path, std::vector<DdcTraceEntry>& out)
+{
+    out.clear();
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    std::unique_ptr<DdcTraceRing> ring(new DdcTraceRing);
+    f.read((char*)ring.get(), sizeof(DdcTraceRing));
+    if (f.gcount() != (std::streamsize)sizeof(DdcTraceRing)) return false;
+    const DdcTraceHeader& h = ring->header;
+    if (h.magic != DDC_TRACE_MAGIC || h.version != DDC_TRACE_VERSION ||
+        h.recordSize != sizeof(DdcTraceRecord) || h.capacity != DDC_TRACE_CAPACITY)
+        return false;
+
+    ReadRing(ring.get(), out);
+    return true;
+}
+
+// ---------- Decoding ----------
+
+std::string DescribeDdcFrame(const DdcTraceEntry& e)
+{
+    const std::vector<unsigned char>& b = e.bytes;
+    char buf[96];
+    if (e.dir == DdcTraceDir::tx) {
+        // 0x6E, sub, 0x80 | n, opcode, ...
+        if (b.size() < 4) return "short frame";
+        switch (b[3]) {
+        case 0x03:
+            if (b.size() < 7) break;
+            snprintf(buf, sizeof(buf), "Set VCP 0x%02X = 0x%04X (sub 0x%02X)", b[4], (b[5] << 8) | b[6], b[1]);
+            return buf;
+        case 0x01:
+            if (b.size() < 5) break;
+            snprintf(buf, sizeof(buf), "Get VCP 0x%02X (sub 0x%02X)", b[4], b[1]);
+            return buf;
+        case 0xF3:
+            if (b.size() < 6) break;
+            snprintf(buf, sizeof(buf), "Capabilities request @%u", (b[4] << 8) | b[5]);
+            return buf;
+        }
+        snprintf(buf, sizeof(buf), "opcode 0x%02X", b[3]);
+        return buf;
+    }
+
+    // 0x6E, 0x80 | n, opcode, ...
+    if (e.rc != 0 && b.empty()) return "no reply";
+    if (b.size() < 2) return "short reply";
+    if ((b[1] & 0x7F) == 0) return "null message";
+    if (b.size() < 3) return "short reply";
+    switch (b[2]) {
+    case 0x02:
+        if (b.size() < 10) break;
+        snprintf(buf, sizeof(buf), "VCP reply 0x%02X %s cur %u max %u", b[4], b[3] ? "unsupported" : "ok",
+            (b[8] << 8) | b[9], (b[6] << 8) | b[7]);
+        return buf;
+    case 0xE3:
+        if (b.size() < 5) break;
+        snprintf(buf, sizeof(buf), "Capabilities fragment @%u, %d bytes", (b[3] << 8) | b[4], (int)(b[1] & 0x7F) - 3);
+        return buf;
+    }
+    snprintf(buf, sizeof(buf), "reply opcode 0x%02X", b[2]);
+    return buf;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef DDC_TRACE_H
+#define DDC_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Always-on trace of the raw DDC/CI bytes on the wire.
+//
+// A fixed ring of 64-byte records: each frame sent and each reply received, with a
+// steady-clock timestamp, the target and the transport's status. Writers claim a slot
+// with one atomic increment and publish it with a sequence number (no locks), so tracing
+// costs a few tens of nanoseconds per frame. The ring lives in process memory unless
+// OpenDdcTraceFile maps it onto a file, in which case it survives a crash and can be
+// decoded afterwards (amdddc-windows trace-dump <file>).
+
+#define DDC_TRACE_CAPACITY   4096  // records; a power of two
+#define DDC_TRACE_MAX_BYTES  36    // frame bytes kept per record; longer frames are cut
+
+enum class DdcTraceDir : std::uint8_t { tx = 1, rx = 2 };
+
+// Hot path: called by the bus scheduler (ddc_bus.h) for every frame. timeNs is when the
+// frame went out (DdcTraceNowNs() taken before the transport call); 0 = now.
+void DdcTraceFrame(int adapterIdx, int displayIdx, DdcTraceDir dir, const unsigned char* bytes, int len, int rc,
+    std::uint64_t timeNs = 0);
+std::uint64_t DdcTraceNowNs();
+
+// Back the ring with a file (created or reset; an existing trace is kept as <path>.prev).
+// Call before DDC traffic starts; records already in memory are not carried over.
+bool OpenDdcTraceFile(const std::string& path);
+
+struct DdcTraceEntry {
+    std::uint64_t seq = 0;          // 1-based, in claim order
+    std::uint64_t timeNs = 0;       // steady clock
+    long long wallMs = 0;           // same instant as Unix time in ms (from the ring's anchor)
+    int adapterIdx = 0;
+    int displayIdx = 0;
+    int rc = 0;
+    DdcTraceDir dir = DdcTraceDir::tx;
+    unsigned int fullLen = 0;       // frame length on the wire
+    std::vector<unsigned char> bytes;
+};
+
+// Records currently in the in-process ring (or the mapped file), oldest first
+std::vector<DdcTraceEntry> SnapshotDdcTrace();
+
+// Records in a trace file written by OpenDdcTraceFile, oldest first
+bool ReadDdcTraceFile(const std::string& path, std::vector<DdcTraceEntry>& out);
+
+// One-line decoding of a frame ("Set VCP 0xF4 = 0x00D1", "VCP reply 0x10 cur 50 max 100", ...)
+std::string DescribeDdcFrame(const DdcTraceEntry& e);
+
+#endif // !DDC_TRACE_H
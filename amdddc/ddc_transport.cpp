@@ -0,0 +1,96 @@
+#include "ddc_transport.h"
+#include "ddc_metrics.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <chrono>
+#include <future>
+#include <mutex>
+
+static std::mutex g_transportLock;
+static std::unique_ptr<DdcTransport> g_transport;
+
+static std::mutex g_prewarmLock;
+static std::shared_future<bool> g_prewarm;   // valid once PrewarmTransport has run
+
+int DdcTransport::EnumerateAdapters(std::vector<DdcAdapterInfo>& out)
+{
+    out.clear();
+    std::vector<DdcDisplayInfo> displays;
+    const int rc = Enumerate(displays);
+    if (rc != ADL_OK) return rc;
+    for (const auto& d : displays) {
+        if (!out.empty() && out.back().adapterIdx == d.adapterIdx) continue;
+        DdcAdapterInfo a;
+        a.adapterIdx = d.adapterIdx;
+        out.push_back(a);
+    }
+    return ADL_OK;
+}
+
+std::unique_ptr<DdcTransport> CreateTransport(const std::string& name)
+{
+    if (name == "adl") return CreateAdlTransport();
+#ifdef __linux__
+    if (name == "i2c") return CreateI2cDevTransport();
+#endif
+    if (name == "sim") return CreateSimTransport();
+    return nullptr;
+}
+
+static std::unique_ptr<DdcTransport> CreateDefaultTransport()
+{
+#ifdef _WIN32
+    return CreateAdlTransport();
+#elif defined(__linux__)
+    return CreateI2cDevTransport();
+#else
+    return CreateSimTransport();
+#endif
+}
+
+DdcTransport* ActiveTransport()
+{
+    std::lock_guard<std::mutex> lock(g_transportLock);
+    if (!g_transport) g_transport = CreateDefaultTransport();
+    return g_transport.get();
+}
+
+void SetActiveTransport(std::unique_ptr<DdcTransport> t)
+{
+    std::lock_guard<std::mutex> lock(g_transportLock);
+    g_transport = std::move(t);
+}
+
+static std::uint64_t MsSince(std::chrono::steady_clock::time_point t0)
+{
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+void PrewarmTransport()
+{
+    std::lock_guard<std::mutex> lock(g_prewarmLock);
+    if (g_prewarm.valid()) return;
+    g_prewarm = std::async(std::launch::async, [] {
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool ok = ActiveTransport()->Open();
+        RecordDdcPhaseMs("transportOpen", MsSince(t0));
+        return ok;
+    }).share();
+}
+
+bool OpenActiveTransport()
+{
+    std::shared_future<bool> prewarm;
+    {
+        std::lock_guard<std::mutex> lock(g_prewarmLock);
+        prewarm = g_prewarm;
+    }
+    if (prewarm.valid() && prewarm.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        const auto t0 = std::chrono::steady_clock::now();
+        prewarm.wait();
+        RecordDdcPhaseMs("transportWait", MsSince(t0));
+    }
+    // A failed prewarm is retried here, like any other first Open
+    DdcTransport* t = ActiveTransport();
+    return t && t->Open();
+}
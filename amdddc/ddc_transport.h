@@ -0,0 +1,102 @@
+#pragma once
+#ifndef DDC_TRANSPORT_H
+#define DDC_TRANSPORT_H
+
+#include "ddc_sim_monitor.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Raw DDC/CI byte transport used by the switching core.
+//
+// Frames are passed exactly as they appear on the wire, starting with the 0x6E
+// destination address byte. Every backend reports status with the ADL codes from
+// adl_defines.h (ADL_OK on success, ADL_ERR_* otherwise) so callers don't care
+// which one is active.
+//
+// Display addressing:
+//   adl  - {adapter, display} are ADL adapter/display indices (real driver or adl_mock)
+//   i2c  - adapter is the N in /dev/i2c-N, display is ignored
+//   sim  - any pair; each distinct pair is its own simulated monitor
+
+// One display as the backend enumerates it
+struct DdcDisplayInfo {
+    int adapterIdx = 0;
+    int displayIdx = 0;
+    std::string name;   // driver's display name, or the bus name where there is none
+};
+
+// One adapter (GPU, or I2C bus) as the backend enumerates it
+struct DdcAdapterInfo {
+    int adapterIdx = 0;
+    std::string name;   // empty where the backend has no name for it
+};
+
+class DdcTransport {
+public:
+    virtual ~DdcTransport() = default;
+
+    virtual const char* Name() const = 0;
+
+    // Prepare the backend (load libraries, create contexts). Safe to call repeatedly.
+    virtual bool Open() = 0;
+
+    // Send one complete frame to the display.
+    virtual int Write(int adapterIdx, int displayIdx, const unsigned char* frame, int len) = 0;
+
+    // Send a request frame and read the display's reply. *ioReplyLen holds the reply buffer
+    // size on entry and the number of bytes received on return. Reply bytes start with the
+    // 0x6E source address, as on the wire. Backends that need it wait the DDC/CI reply delay
+    // (DDC_REPLY_DELAY_MS) between the two halves.
+    virtual int WriteRead(int adapterIdx, int displayIdx, const unsigned char* request, int requestLen,
+        unsigned char* reply, int* ioReplyLen) = 0;
+
+    // Read the display's EDID (base block first). *ioLen holds the buffer size on entry
+    // and the number of bytes read on return.
+    virtual int ReadEdid(int adapterIdx, int displayIdx, unsigned char* buf, int* ioLen) = 0;
+
+    // Connected displays, in the addressing above. Uses only call-local buffers.
+    virtual int Enumerate(std::vector<DdcDisplayInfo>& out) = 0;
+
+    // Adapters, including those with nothing connected. The default lists the adapters
+    // Enumerate reports displays on, without names.
+    virtual int EnumerateAdapters(std::vector<DdcAdapterInfo>& out);
+};
+
+// DDC/CI minimum gaps: after any write before the next message, and between a request
+// and reading its reply.
+static const int DDC_WRITE_GAP_MS = 50;
+static const int DDC_REPLY_DELAY_MS = 40;
+
+struct SimTransportOptions {
+    unsigned int writeLatencyUs = 0;  // artificial per-message bus time
+    DdcSimMonitorModel model;         // timing and faults of every simulated monitor
+    std::vector<std::pair<int, int>> displays = { { 5, 0 } }; // {adapter, display} pairs Enumerate reports
+};
+
+// Outside Windows the ADL backend only works with the ADL mock installed (adl_mock.h)
+std::unique_ptr<DdcTransport> CreateAdlTransport();
+#ifdef __linux__
+std::unique_ptr<DdcTransport> CreateI2cDevTransport();
+#endif
+std::unique_ptr<DdcTransport> CreateSimTransport(const SimTransportOptions& opts = SimTransportOptions());
+
+// "adl", "i2c" or "sim". Returns nullptr for names not available on this platform.
+std::unique_ptr<DdcTransport> CreateTransport(const std::string& name);
+
+// Process-wide transport used by SetVcpFeatureWithI2cAddr. Created on first use
+// (ADL on Windows, i2c-dev on Linux) unless one was installed beforehand.
+DdcTransport* ActiveTransport();
+void SetActiveTransport(std::unique_ptr<DdcTransport> t);
+
+// Opens the active transport on a background thread (std::async), so the first switch
+// doesn't pay for it: on ADL that is LoadLibrary plus ADL_Main_Control_Create, hundreds of
+// ms. Install any other transport first. Records the "transportOpen" phase (ddc_metrics.h).
+void PrewarmTransport();
+
+// Open() on the active transport, after waiting for a prewarm still in flight (recorded as
+// the "transportWait" phase). What the switching core calls before talking to a display.
+bool OpenActiveTransport();
+
+#endif // !DDC_TRANSPORT_H
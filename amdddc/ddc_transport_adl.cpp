@@ -0,0 +1,162 @@
+#include "ddc_transport.h"
+#include "adl.h"
+#include <cstring>
+#include <mutex>
+
+// The original path: ADL_Display_DDCBlockAccess_Get. Writes pass no receive buffer;
+// reads let the driver perform the write / delay / read sequence in one call.
+class AdlTransport : public DdcTransport {
+public:
+    const char* Name() const override { return "adl"; }
+
+    bool Open() override
+    {
+        // Initialize ADL exactly once for this process
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_inited) return true;
+        if (!InitADL()) return false;
+        m_inited = true;
+        return true;
+    }
+
+    int Write(int adapterIdx, int displayIdx, const unsigned char* frame, int len) override
+    {
+        int iRev = 0;
+        std::lock_guard<std::mutex> call(m_callLock);
+        // int ADL_Display_DDCBlockAccess_Get(int adapter, int display, int iOffset, int iCommand,
+        //                                    int iDataSize, char* lpData, int* lpRead, char* lpReadBuffer);
+        return adlprocs.ADL_Display_DDCBlockAccess_Get(
+            adapterIdx,
+            displayIdx,
+            0,                // iOffset
+            0,                // iCommand
+            len,
+            (char*)frame,
+            &iRev,
+            (char*)0          // lpReadBuffer
+        );
+    }
+
+    int WriteRead(int adapterIdx, int displayIdx, const unsigned char* request, int requestLen,
+        unsigned char* reply, int* ioReplyLen) override
+    {
+        std::lock_guard<std::mutex> call(m_callLock);
+        return adlprocs.ADL_Display_DDCBlockAccess_Get(
+            adapterIdx,
+            displayIdx,
+            0,
+            0,
+            requestLen,
+            (char*)request,
+            ioReplyLen,
+            (char*)reply
+        );
+    }
+
+    int ReadEdid(int adapterIdx, int displayIdx, unsigned char* buf, int* ioLen) override
+    {
+        if (!buf || !ioLen || *ioLen <= 0) return ADL_ERR_INVALID_PARAM;
+
+        ADLDisplayEDIDData edid{};
+        edid.iSize = sizeof(edid);
+        edid.iBlockIndex = 0;
+        int rc;
+        {
+            std::lock_guard<std::mutex> call(m_callLock);
+            rc = adlprocs.ADL_Display_EdidData_Get(adapterIdx, displayIdx, &edid);
+        }
+        if (rc != ADL_OK) {
+            *ioLen = 0;
+            return rc;
+        }
+
+        int n = edid.iEDIDSize;
+        if (n > ADL_MAX_EDIDDATA_SIZE) n = ADL_MAX_EDIDDATA_SIZE;
+        if (n > *ioLen) n = *ioLen;
+        for (int i = 0; i < n; ++i) buf[i] = (unsigned char)edid.cEDIDData[i];
+        *ioLen = n;
+        return ADL_OK;
+    }
+
+    int Enumerate(std::vector<DdcDisplayInfo>& out) override
+    {
+        out.clear();
+        std::lock_guard<std::mutex> call(m_callLock);
+
+        std::vector<AdapterInfo> adapters;
+        int rc = AdapterList(adapters);
+        if (rc != ADL_OK) return rc;
+
+        const int required = ADL_DISPLAY_DISPLAYINFO_DISPLAYCONNECTED | ADL_DISPLAY_DISPLAYINFO_DISPLAYMAPPED;
+        for (int i = 0; i < (int)adapters.size(); ++i) {
+            const int adapterIndex = adapters[i].iAdapterIndex;
+            int displayCount = 0;
+            LPADLDisplayInfo displays = nullptr;
+            if (adlprocs.ADL_Display_DisplayInfo_Get(adapterIndex, &displayCount, &displays, 0) != ADL_OK || !displays) {
+                if (displays) ADL_Main_Memory_Free((void**)&displays);
+                continue;
+            }
+
+            for (int j = 0; j < displayCount; ++j) {
+                const auto& di = displays[j];
+                // Connected AND mapped, and mapped to this adapter
+                if ((di.iDisplayInfoValue & required) != required) continue;
+                if (adapterIndex != di.displayID.iDisplayLogicalAdapterIndex) continue;
+
+                DdcDisplayInfo info;
+                info.adapterIdx = adapterIndex;
+                info.displayIdx = di.displayID.iDisplayLogicalIndex;
+                info.name = di.strDisplayName;
+                out.push_back(info);
+            }
+            ADL_Main_Memory_Free((void**)&displays);
+        }
+        return ADL_OK;
+    }
+
+    int EnumerateAdapters(std::vector<DdcAdapterInfo>& out) override
+    {
+        out.clear();
+        std::lock_guard<std::mutex> call(m_callLock);
+
+        std::vector<AdapterInfo> adapters;
+        const int rc = AdapterList(adapters);
+        if (rc != ADL_OK) return rc;
+        for (const auto& a : adapters) {
+            DdcAdapterInfo info;
+            info.adapterIdx = a.iAdapterIndex;
+            info.name = a.strAdapterName;
+            out.push_back(info);
+        }
+        return ADL_OK;
+    }
+
+private:
+    // ADL's adapter table, into a call-local buffer. Called with m_callLock held.
+    static int AdapterList(std::vector<AdapterInfo>& out)
+    {
+        out.clear();
+        int nAdapters = 0;
+        int rc = adlprocs.ADL_Adapter_NumberOfAdapters_Get(&nAdapters);
+        if (rc != ADL_OK) return rc;
+        if (nAdapters <= 0) return ADL_OK;
+
+        out.resize((size_t)nAdapters);
+        memset(out.data(), 0, sizeof(AdapterInfo) * nAdapters);
+        rc = adlprocs.ADL_Adapter_AdapterInfo_Get(out.data(), (int)(sizeof(AdapterInfo) * nAdapters));
+        if (rc != ADL_OK) out.clear();
+        return rc;
+    }
+
+    std::mutex m_lock;
+    bool m_inited = false;
+    // The legacy (context-less) ADL entry points aren't documented as thread-safe, so the
+    // DDC calls themselves are serialized. They take a few ms; the settle waits that
+    // dominate a switch still overlap across displays.
+    std::mutex m_callLock;
+};
+
+std::unique_ptr<DdcTransport> CreateAdlTransport()
+{
+    return std::make_unique<AdlTransport>();
+}
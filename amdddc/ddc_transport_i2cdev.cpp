@@ -0,0 +1,201 @@
+#ifdef __linux__
+
+#include "ddc_transport.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+// DDC/CI slave address (0x6E on the wire is 0x37 << 1 | write)
+static const unsigned short DDC_I2C_ADDR = 0x37;
+// E-DDC EDID EEPROM address
+static const unsigned short EDID_I2C_ADDR = 0x50;
+
+// Map errno from the i2c-dev driver onto the ADL status codes the core understands.
+static int AdlErrFromErrno(int e)
+{
+    switch (e) {
+    case ENOENT:
+    case ENODEV:      return ADL_ERR_INVALID_ADL_IDX;
+    case EACCES:
+    case EPERM:       return ADL_ERR_NO_ADMINISTRATOR_PRIVILEGES;
+    case EBUSY:
+    case EAGAIN:      return ADL_ERR_RESOURCE_CONFLICT;
+    case EINVAL:      return ADL_ERR_INVALID_PARAM;
+    case ENOTTY:
+    case EOPNOTSUPP:  return ADL_ERR_NOT_SUPPORTED;
+    default:          return ADL_ERR; // ENXIO / EREMOTEIO / EIO: NAK or bus error
+    }
+}
+
+// Talks to /dev/i2c-N directly. One descriptor per bus, opened on first use and kept;
+// each bus has its own lock so a reply delay on one bus doesn't stall the others.
+class I2cDevTransport : public DdcTransport {
+public:
+    ~I2cDevTransport() override
+    {
+        for (auto& kv : m_buses)
+            if (kv.second.fd >= 0) close(kv.second.fd);
+    }
+
+    const char* Name() const override { return "i2c"; }
+
+    bool Open() override { return true; } // buses are opened lazily per adapter
+
+    int Write(int adapterIdx, int /*displayIdx*/, const unsigned char* frame, int len) override
+    {
+        if (!frame || len < 2) return ADL_ERR_INVALID_PARAM;
+
+        Bus* bus = nullptr;
+        int rc = GetBus(adapterIdx, bus);
+        if (rc != ADL_OK) return rc;
+
+        std::lock_guard<std::mutex> lock(bus->lock);
+        return Transfer(bus->fd, (unsigned char*)frame + 1, len - 1, 0);
+    }
+
+    int WriteRead(int adapterIdx, int /*displayIdx*/, const unsigned char* request, int requestLen,
+        unsigned char* reply, int* ioReplyLen) override
+    {
+        if (!request || requestLen < 2 || !reply || !ioReplyLen || *ioReplyLen <= 0)
+            return ADL_ERR_INVALID_PARAM;
+
+        Bus* bus = nullptr;
+        int rc = GetBus(adapterIdx, bus);
+        if (rc != ADL_OK) return rc;
+
+        std::lock_guard<std::mutex> lock(bus->lock);
+        rc = Transfer(bus->fd, (unsigned char*)request + 1, requestLen - 1, 0);
+        if (rc != ADL_OK) return rc;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(DDC_REPLY_DELAY_MS));
+
+        rc = Transfer(bus->fd, reply, *ioReplyLen, I2C_M_RD);
+        if (rc != ADL_OK) *ioReplyLen = 0;
+        return rc;
+    }
+
+    int ReadEdid(int adapterIdx, int /*displayIdx*/, unsigned char* buf, int* ioLen) override
+    {
+        if (!buf || !ioLen || *ioLen <= 0) return ADL_ERR_INVALID_PARAM;
+
+        Bus* bus = nullptr;
+        int rc = GetBus(adapterIdx, bus);
+        if (rc != ADL_OK) return rc;
+
+        // Set the EEPROM offset to 0, then read the base block in the same transaction
+        unsigned char offset = 0;
+        const int want = *ioLen < 128 ? *ioLen : 128;
+        i2c_msg msgs[2] = {};
+        msgs[0].addr = EDID_I2C_ADDR;
+        msgs[0].flags = 0;
+        msgs[0].len = 1;
+        msgs[0].buf = &offset;
+        msgs[1].addr = EDID_I2C_ADDR;
+        msgs[1].flags = I2C_M_RD;
+        msgs[1].len = (unsigned short)want;
+        msgs[1].buf = buf;
+        i2c_rdwr_ioctl_data xfer{ msgs, 2 };
+
+        std::lock_guard<std::mutex> lock(bus->lock);
+        if (ioctl(bus->fd, I2C_RDWR, &xfer) < 0) {
+            *ioLen = 0;
+            return AdlErrFromErrno(errno);
+        }
+        *ioLen = want;
+        return ADL_OK;
+    }
+
+    // Every /dev/i2c-N node; which of them has a monitor behind it only shows when its
+    // EDID is read.
+    int Enumerate(std::vector<DdcDisplayInfo>& out) override
+    {
+        out.clear();
+        DIR* dir = opendir("/dev");
+        if (!dir) return AdlErrFromErrno(errno);
+        while (dirent* e = readdir(dir)) {
+            if (strncmp(e->d_name, "i2c-", 4) != 0) continue;
+            char* end = nullptr;
+            long n = strtol(e->d_name + 4, &end, 10);
+            if (end == e->d_name + 4 || *end != '\0') continue;
+
+            DdcDisplayInfo info;
+            info.adapterIdx = (int)n;
+            info.displayIdx = 0;
+            info.name = e->d_name;
+            out.push_back(info);
+        }
+        closedir(dir);
+        std::sort(out.begin(), out.end(),
+            [](const DdcDisplayInfo& a, const DdcDisplayInfo& b) { return a.adapterIdx < b.adapterIdx; });
+        return ADL_OK;
+    }
+
+private:
+    struct Bus {
+        std::mutex lock;
+        int fd = -1;
+    };
+
+    int GetBus(int busNumber, Bus*& out)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        Bus& bus = m_buses[busNumber];
+        if (bus.fd < 0) {
+            const std::string path = "/dev/i2c-" + std::to_string(busNumber);
+            int fd = open(path.c_str(), O_RDWR);
+            if (fd < 0) return AdlErrFromErrno(errno);
+            if (ioctl(fd, I2C_SLAVE, DDC_I2C_ADDR) < 0) {
+                int e = errno;
+                close(fd);
+                return AdlErrFromErrno(e);
+            }
+            bus.fd = fd;
+        }
+        out = &bus;
+        return ADL_OK;
+    }
+
+    // One I2C message to the DDC slave. The 0x6E address byte is never part of buf:
+    // i2c-dev addresses the slave itself.
+    static int Transfer(int fd, unsigned char* buf, int len, unsigned short flags)
+    {
+        i2c_msg msg{};
+        msg.addr = DDC_I2C_ADDR;
+        msg.flags = flags;
+        msg.len = (unsigned short)len;
+        msg.buf = buf;
+        i2c_rdwr_ioctl_data xfer{ &msg, 1 };
+        if (ioctl(fd, I2C_RDWR, &xfer) >= 0) return ADL_OK;
+
+        // Adapters without I2C_RDWR still accept plain read()/write() on the I2C_SLAVE address
+        if (errno == ENOTTY || errno == EOPNOTSUPP) {
+            ssize_t n = (flags & I2C_M_RD) ? read(fd, buf, (size_t)len) : write(fd, buf, (size_t)len);
+            if (n == len) return ADL_OK;
+            if (n >= 0) return ADL_ERR;
+        }
+        return AdlErrFromErrno(errno);
+    }
+
+    std::mutex m_lock;
+    std::map<int, Bus> m_buses; // bus number -> descriptor (node-stable, so Bus* stays valid)
+};
+
+std::unique_ptr<DdcTransport> CreateI2cDevTransport()
+{
+    return std::make_unique<I2cDevTransport>();
+}
+
+#endif // __linux__
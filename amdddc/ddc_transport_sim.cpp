@@ -0,0 +1,93 @@
+#include "ddc_transport.h"
+#include "ddc_edid.h"
+#include "ddc_sim_monitor.h"
+#include "../adl-sdk/include/adl_defines.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+// In-process stand-in for the displays: each {adapter, display} pair gets its own simulated
+// monitor (ddc_sim_monitor.h), all following SimTransportOptions::model.
+class SimTransport : public DdcTransport {
+public:
+    explicit SimTransport(const SimTransportOptions& opts) : m_opts(opts) {}
+
+    const char* Name() const override { return "sim"; }
+
+    bool Open() override { return true; }
+
+    int Write(int adapterIdx, int displayIdx, const unsigned char* frame, int len) override
+    {
+        BusDelay();
+        return Monitor(adapterIdx, displayIdx).Write(frame, len);
+    }
+
+    int WriteRead(int adapterIdx, int displayIdx, const unsigned char* request, int requestLen,
+        unsigned char* reply, int* ioReplyLen) override
+    {
+        BusDelay();
+        return Monitor(adapterIdx, displayIdx).WriteRead(request, requestLen, reply, ioReplyLen);
+    }
+
+    int Enumerate(std::vector<DdcDisplayInfo>& out) override
+    {
+        out.clear();
+        for (const auto& d : m_opts.displays) {
+            DdcDisplayInfo info;
+            info.adapterIdx = d.first;
+            info.displayIdx = d.second;
+            info.name = "SIM MONITOR";
+            out.push_back(info);
+        }
+        return ADL_OK;
+    }
+
+    // Every simulated monitor is the same model; only the serial number differs
+    int ReadEdid(int adapterIdx, int displayIdx, unsigned char* buf, int* ioLen) override
+    {
+        if (!buf || !ioLen || *ioLen < EDID_BLOCK_SIZE) return ADL_ERR_INVALID_PARAM;
+
+        EdidIdentity id;
+        id.manufacturer = "GSM";
+        id.product = 0x1234;
+        id.serial = ((unsigned int)adapterIdx << 8) | (unsigned int)(displayIdx & 0xFF);
+        unsigned char e[EDID_BLOCK_SIZE];
+        BuildEdidBlock(id, "SIM MONITOR", e);
+
+        for (int i = 0; i < EDID_BLOCK_SIZE; ++i) buf[i] = e[i];
+        *ioLen = EDID_BLOCK_SIZE;
+        return ADL_OK;
+    }
+
+private:
+    // Created on first use; std::map keeps the reference valid as others are added
+    DdcSimMonitor& Monitor(int adapterIdx, int displayIdx)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto it = m_monitors.find({ adapterIdx, displayIdx });
+        if (it == m_monitors.end()) {
+            const unsigned int salt = ((unsigned int)adapterIdx << 8) | (unsigned int)(displayIdx & 0xFF);
+            it = m_monitors.emplace(std::piecewise_construct, std::forward_as_tuple(adapterIdx, displayIdx),
+                std::forward_as_tuple(m_opts.model, salt)).first;
+        }
+        return it->second;
+    }
+
+    void BusDelay() const
+    {
+        if (m_opts.writeLatencyUs)
+            std::this_thread::sleep_for(std::chrono::microseconds(m_opts.writeLatencyUs));
+    }
+
+    SimTransportOptions m_opts;
+    std::mutex m_lock;
+    std::map<std::pair<int, int>, DdcSimMonitor> m_monitors;
+};
+
+std::unique_ptr<DdcTransport> CreateSimTransport(const SimTransportOptions& opts)
+{
+    return std::make_unique<SimTransport>(opts);
+}
@@ -12,16 +12,39 @@ void print_help() {
     cout << "Usage: amdddc-windows [options] [command]" << endl;
     cout << "Options:" << endl;
     cout << "  --i2c-source-addr <addr>             Set the I2C source address (Default: 0x51; For LG DualUp, use 0x50, which will then use 0xF4 for the side channel command)" << endl;
+    cout << "  --transport <adl|i2c|sim>            DDC transport (Default: adl on Windows, i2c on Linux; sim is an in-memory monitor)" << endl;
+    cout << "  --adl-mock <script.json>             Answer ADL calls from a scripted topology instead of the driver (works on Linux)" << endl;
+    cout << "  --sim-model <spec>                   Simulated monitor timing and faults, e.g. switch=150,jitter=40,busy=60,nak=0.01,corrupt=0.005" << endl;
+    cout << "  --vcp-code <code>                    VCP code setvcp writes (Default: 0xF4, the input; e.g. 0x10 brightness, 0x62 volume)" << endl;
+    cout << "  --caps-cache <file>                  Capabilities cache, keyed by monitor model (Default: amdddc-caps.json; \"\" disables)" << endl;
+    cout << "  --trace <file>                       Keep the raw frame trace in <file> (survives a crash; the previous one becomes <file>.prev)" << endl;
+    cout << "  --metrics <file>                     Write this run's latency histograms and counters to <file> as JSON" << endl;
+    cout << "  --wait <verify|none|ms>              How setvcp waits for the monitor: read back until the value sticks (Default: verify)," << endl;
+    cout << "                                       don't wait at all, or sleep a fixed number of milliseconds" << endl;
+    cout << "  --connect <endpoint>                 Send setvcp, getvcp and stats (also inside a batch) to a running serve daemon" << endl;
+    cout << "  --json                               Print detect's adapters, displays and EDID identities as JSON" << endl;
     cout << "  --verbose, -v                        Enable verbose output" << endl;
     cout << "  --help, -h                           Print this help message" << endl;
     cout << "Commands:" << endl;
-    cout << "  detect                               Print the available monitors and displays" << endl;
-    cout << "  setvcp <monitor> <display> <input>   Set the VCP command (currently only input switching)" << endl;
+    cout << "  detect                               Print the available adapters and displays with their EDID identity (--json for tools)" << endl;
+    cout << "  setvcp <monitor> <display> <value>   Write a VCP code (the input unless --vcp-code says otherwise) and wait for the readback" << endl;
     cout << "                                       <input> for LG DualUp: 0xD0 for DP1, 0xD1 for DP2/USB-C, 0x90 for HDMI, 0x91 for HDMI2" << endl;
+    cout << "  getvcp <monitor> <display> <code>    Read a VCP code (e.g. 0xF4 with --i2c-source-addr 0x50 for the LG input)" << endl;
+    cout << "  caps <monitor> <display>             Print the monitor's capabilities string and supported VCP codes" << endl;
+    cout << "  trace-dump <file>                    Decode a frame trace written with --trace or by the tray app" << endl;
+    cout << "  stats [file]                         Print latency percentiles and per-display counters from a metrics dump" << endl;
+    cout << "                                       (--metrics, or ddc-metrics.json next to the tray app's config.json); with --connect, the daemon's" << endl;
+    cout << "  soak <switches> <displays>           Switch inputs <switches> times across <displays> simulated monitors in parallel" << endl;
+    cout << "                                       and report throughput and latency percentiles (always uses the sim transport)" << endl;
+    cout << "  batch <file|->                       Run one command per line (same syntax as the command line, # starts a comment)" << endl;
+    cout << "                                       over a single transport session; \"-\" reads stdin. Prints one timing line per operation" << endl;
+    cout << "  serve [endpoint]                     Keep the transport open and answer switch, set, get and stats requests on a local" << endl;
+    cout << "                                       endpoint until Ctrl-C or SIGTERM: a named pipe on Windows (\\\\.\\pipe\\amdddc), a socket path elsewhere" << endl;
+    cout << "                                       (default $XDG_RUNTIME_DIR/amdddc.sock, else /tmp/amdddc-<uid>/amdddc.sock)" << endl;
 }
 
-Settings parse_settings(int argc, const char** argv) {
-    Settings settings;
+Settings parse_settings(int argc, const char** argv, const Settings& defaults) {
+    Settings settings = defaults;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--i2c-source-addr") == 0) {
@@ -36,6 +59,106 @@ Settings parse_settings(int argc, const char** argv) {
                 throw runtime_error{ "missing param after --i2c-source-addr" };
             }
         }
+        else if (strcmp(argv[i], "--transport") == 0) {
+            if (++i < argc) {
+                settings.transport = argv[i];
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --transport" };
+            }
+        }
+        else if (strcmp(argv[i], "--adl-mock") == 0) {
+            if (++i < argc) {
+                settings.adl_mock = argv[i];
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --adl-mock" };
+            }
+        }
+        else if (strcmp(argv[i], "--sim-model") == 0) {
+            if (++i < argc) {
+                settings.sim_model = argv[i];
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --sim-model" };
+            }
+        }
+        else if (strcmp(argv[i], "--vcp-code") == 0) {
+            if (++i < argc) {
+                istringstream converter(argv[i]);
+                unsigned int value;
+                converter >> hex >> value;
+                settings.vcp_code = value;
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --vcp-code" };
+            }
+        }
+        else if (strcmp(argv[i], "--caps-cache") == 0) {
+            if (++i < argc) {
+                settings.caps_cache = argv[i];
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --caps-cache" };
+            }
+        }
+        else if (strcmp(argv[i], "--trace") == 0) {
+            if (++i < argc) {
+                settings.trace_file = argv[i];
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --trace" };
+            }
+        }
+        else if (strcmp(argv[i], "--metrics") == 0) {
+            if (++i < argc) {
+                settings.metrics_file = argv[i];
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --metrics" };
+            }
+        }
+        else if (strcmp(argv[i], "--wait") == 0) {
+            if (++i < argc) {
+                if (strcmp(argv[i], "verify") == 0) {
+                    settings.wait_ms = -1;
+                }
+                else if (strcmp(argv[i], "none") == 0) {
+                    settings.wait_ms = 0;
+                }
+                else {
+                    istringstream converter(argv[i]);
+                    int value = -1;
+                    char extra;
+                    if (!(converter >> value) || converter >> extra || value < 0 || value > 60000)
+                        throw runtime_error{ "--wait takes verify, none or 0..60000 ms" };
+                    settings.wait_ms = value;
+                }
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --wait" };
+            }
+        }
+        else if (strcmp(argv[i], "--connect") == 0) {
+            if (++i < argc) {
+                settings.connect = argv[i];
+            }
+            else
+            {
+                throw runtime_error{ "missing param after --connect" };
+            }
+        }
+        else if (strcmp(argv[i], "--json") == 0) {
+            settings.json = true;
+        }
         else if ((strcmp(argv[i], "--verbose") == 0) || (strcmp(argv[i], "-v") == 0)) {
             settings.verbose = true;
         }
@@ -61,6 +184,82 @@ Settings parse_settings(int argc, const char** argv) {
                 throw runtime_error{ "missing param after setvcp" };
             }
         }
+        else if (strcmp(argv[i], command_to_string.at(getvcp)) == 0) {
+            if (i + 3 < argc) {
+                istringstream converter1(argv[++i]), converter2(argv[++i]), converter3(argv[++i]);
+                unsigned int value1, value2, value3;
+                converter1 >> value1;
+                converter2 >> value2;
+                converter3 >> hex >> value3;
+                settings.monitor = value1;
+                settings.display = value2;
+                settings.vcp_code = value3;
+                settings.command = getvcp;
+            }
+            else {
+                throw runtime_error{ "missing param after getvcp" };
+            }
+        }
+        else if (strcmp(argv[i], command_to_string.at(caps)) == 0) {
+            if (i + 2 < argc) {
+                istringstream converter1(argv[++i]), converter2(argv[++i]);
+                unsigned int value1, value2;
+                converter1 >> value1;
+                converter2 >> value2;
+                settings.monitor = value1;
+                settings.display = value2;
+                settings.command = caps;
+            }
+            else {
+                throw runtime_error{ "missing param after caps" };
+            }
+        }
+        else if (strcmp(argv[i], command_to_string.at(trace_dump)) == 0) {
+            if (i + 1 < argc) {
+                settings.trace_file = argv[++i];
+                settings.command = trace_dump;
+            }
+            else {
+                throw runtime_error{ "missing param after trace-dump" };
+            }
+        }
+        else if (strcmp(argv[i], command_to_string.at(stats)) == 0) {
+            // The file is optional: with --connect the daemon's metrics are printed instead
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                settings.metrics_file = argv[++i];
+            settings.command = stats;
+        }
+        else if (strcmp(argv[i], command_to_string.at(soak)) == 0) {
+            if (i + 2 < argc) {
+                istringstream converter1(argv[++i]), converter2(argv[++i]);
+                unsigned int value1 = 0, value2 = 0;
+                converter1 >> value1;
+                converter2 >> value2;
+                if (!value1 || !value2)
+                    throw runtime_error{ "soak needs a switch count and a display count above 0" };
+                settings.soak_switches = value1;
+                settings.soak_displays = value2;
+                settings.command = soak;
+            }
+            else {
+                throw runtime_error{ "missing param after soak" };
+            }
+        }
+        else if (strcmp(argv[i], command_to_string.at(batch)) == 0) {
+            if (i + 1 < argc) {
+                settings.batch_file = argv[++i];
+                settings.command = batch;
+            }
+            else {
+                throw runtime_error{ "missing param after batch" };
+            }
+        }
+        else if (strcmp(argv[i], command_to_string.at(serve)) == 0) {
+            // The endpoint is optional: DefaultDdcServerEndpoint (ddc_server.h) otherwise
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                settings.serve_endpoint = argv[++i];
+            settings.command = serve;
+        }
         else {
             throw runtime_error{ "unrecognized command-line option" };
         }
@@ -69,10 +268,14 @@ Settings parse_settings(int argc, const char** argv) {
     if (settings.verbose) {
 		cerr << "Settings:" << endl;
 		cerr << "  i2c_subaddress: " << hex << settings.i2c_subaddress << endl;
+		cerr << "  transport: " << (settings.transport.empty() ? "(default)" : settings.transport) << endl;
+		cerr << "  adl_mock: " << (settings.adl_mock.empty() ? "(none)" : settings.adl_mock) << endl;
 		cerr << "  verbose: " << settings.verbose << endl;
 		cerr << "  help: " << settings.help << endl;
 		cerr << "  command: " << command_to_string.at(settings.command) << endl;
 		cerr << "  input: " << hex << settings.input << endl;
+		cerr << "  vcp_code: " << hex << settings.vcp_code << endl;
+		cerr << "  wait: " << (settings.wait_ms < 0 ? "verify" : to_string(settings.wait_ms) + " ms") << endl;
 		cerr << "  monitor: " << settings.monitor << endl;
 		cerr << "  display: " << settings.display << endl;
     }
@@ -10,6 +10,13 @@
 enum Command {
     detect,
     setvcp,
+    getvcp,
+    caps,
+    trace_dump,
+    stats,
+    soak,
+    batch,
+    serve,
     unknown
 };
 
@@ -18,17 +25,39 @@ struct Settings {
     bool verbose{ false };
     Command command = unknown;
     unsigned int i2c_subaddress{ 0x51 };
+    std::string transport;  // empty: platform default (adl on Windows)
+    std::string adl_mock;   // ADL mock script (adl_mock.h); implies --transport adl
+    std::string sim_model;  // --sim-model: ParseSimMonitorModel spec for the sim transport's monitors
     unsigned int input;
+    unsigned int vcp_code{ 0xF4 };   // getvcp's code, or what setvcp writes (--vcp-code)
+    std::string caps_cache{ "amdddc-caps.json" };  // empty: always read capabilities live
+    std::string trace_file;  // --trace: map the frame trace onto this file; trace-dump: file to decode
+    std::string metrics_file;  // --metrics: dump this run's latency metrics here; stats: dump to print
     unsigned int monitor;
     unsigned int display;
+    unsigned int soak_switches{ 0 };
+    unsigned int soak_displays{ 0 };
+    std::string batch_file;  // batch: one command per line; "-" reads stdin
+    std::string serve_endpoint;  // serve: named pipe (Windows) or Unix socket path to listen on; empty = the default
+    std::string connect;     // --connect: run setvcp / getvcp / stats on the serve daemon at this endpoint
+    bool json{ false };      // --json: machine-readable output (detect)
+    int wait_ms{ -1 };       // --wait: -1 reads back until the value sticks, 0 doesn't wait, > 0 sleeps that long
 };
 
 static const std::unordered_map<Command, const char*> command_to_string{
 	{detect, "detect"},
-	{setvcp, "setvcp"}
+	{setvcp, "setvcp"},
+	{getvcp, "getvcp"},
+	{caps, "caps"},
+	{trace_dump, "trace-dump"},
+	{stats, "stats"},
+	{soak, "soak"},
+	{batch, "batch"},
+	{serve, "serve"}
 };
 
-Settings parse_settings(int, const char**);
+// Options not given on the command line keep their value in defaults (batch lines inherit the outer options)
+Settings parse_settings(int, const char**, const Settings& defaults = Settings());
 void print_help();
 
 #endif // !SETTINGS_H
\ No newline at end of file
@@ -1,9 +1,13 @@
 ﻿#include "app_config.h"
-#include "util.h"
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <filesystem>
+#include <set>
 #include <sstream>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include "../external/json.hpp"
 
 using nlohmann::json;
@@ -11,9 +15,14 @@ using nlohmann::json;
 // ---------- Paths ----------
 
 static std::string ExeDir() {
+#ifdef _WIN32
     char exePath[MAX_PATH];
     GetModuleFileNameA(NULL, exePath, MAX_PATH);
     return std::filesystem::path(exePath).parent_path().string();
+#else
+    std::error_code ec;
+    return std::filesystem::read_symlink("/proc/self/exe", ec).parent_path().string();
+#endif
 }
 
 std::string ConfigPath() {
@@ -30,7 +39,7 @@ bool EnsureConfigDir() {
 
 static AppConfig Defaults() {
     AppConfig c;
-    c.targets = { {5, 0} };
+    c.targets = { Target{ 5, 0 } };
     c.inputs = {
         {"DisplayPort", "0xD0"},
         {"USB-C",       "0xD1"},
@@ -39,6 +48,12 @@ static AppConfig Defaults() {
     };
     c.cycleOrder = { "DisplayPort", "USB-C", "HDMI1", "HDMI2" };
     c.i2cSourceAddr = "0x50"; // LG alt path
+    c.controls = {
+        {"Brightness", "0x10", 5, "", ""},
+        {"Contrast",   "0x12", 5, "", ""},
+        {"Volume",     "0x62", 5, "", ""}
+    };
+    c.controlI2cAddr = "0x51";
     c.hotkeys.cycle = "CTRL+ALT+1";
     c.hotkeys.direct = {
         {"DisplayPort", "CTRL+ALT+2"},
@@ -47,6 +62,8 @@ static AppConfig Defaults() {
         {"HDMI2",       "CTRL+ALT+5"}
     };
     c.debounceMs = 750;
+    c.coalesceCycle = true;
+    c.settleTimeoutMs = 700;
     c.showNotifications = true;
     c.startWithWindows = false;
     return c;
@@ -65,7 +82,14 @@ static std::string Escape(const std::string& s) {
         case '\n': o << "\\n";  break;
         case '\r': o << "\\r";  break;
         case '\t': o << "\\t";  break;
-        default:   o << c;      break;
+        default:
+            // Other control characters aren't valid raw in a JSON string
+            if ((unsigned char)c < 0x20) {
+                static const char hex[] = "0123456789abcdef";
+                o << "\\u00" << hex[(unsigned char)c >> 4] << hex[c & 0xF];
+            }
+            else o << c;
+            break;
         }
     }
     return o.str();
@@ -78,10 +102,39 @@ static std::string ToJson(const AppConfig& c) {
     // targets
     out << "  \"targets\": [";
     for (size_t i = 0; i < c.targets.size(); ++i) {
-        if (i) out << ", ";
-        out << "[" << c.targets[i].first << ", " << c.targets[i].second << "]";
+        const auto& t = c.targets[i];
+        out << (i ? ",\n    " : "\n    ");
+        out << "{\"adapter\": " << t.adapterIndex << ", \"display\": " << t.displayIndex;
+        if (t.id.Valid()) {
+            out << ", \"manufacturer\": \"" << Escape(t.id.manufacturer) << "\", \"product\": " << t.id.product
+                << ", \"serial\": " << t.id.serial << ", \"serialText\": \"" << Escape(t.id.serialText) << "\"";
+        }
+        if (t.latency.samples) {
+            // One decimal is plenty for an average of millisecond samples
+            out << ", \"latency\": {\"ewmaMs\": " << (long long)(t.latency.ewmaMs * 10 + 0.5) / 10.0
+                << ", \"samples\": " << t.latency.samples << ", \"recent\": [";
+            for (size_t r = 0; r < t.latency.recent.size(); ++r)
+                out << (r ? ", " : "") << t.latency.recent[r];
+            out << "]}";
+        }
+        out << "}";
     }
-    out << "],\n";
+    out << (c.targets.empty() ? "],\n" : "\n  ],\n");
+
+    // groups
+    out << "  \"groups\": [";
+    for (size_t i = 0; i < c.groups.size(); ++i) {
+        const auto& g = c.groups[i];
+        out << (i ? ",\n    " : "\n    ");
+        out << "{\"name\": \"" << Escape(g.name) << "\", \"targets\": [";
+        for (size_t m = 0; m < g.members.size(); ++m) {
+            if (m) out << ", ";
+            out << g.members[m];
+        }
+        out << "]}";
+    }
+    out << (c.groups.empty() ? "],\n" : "\n  ],\n");
+    out << "  \"activeGroup\": \"" << Escape(c.activeGroup) << "\",\n";
 
     // inputs
     out << "  \"inputs\": [\n";
@@ -103,6 +156,31 @@ static std::string ToJson(const AppConfig& c) {
     // i2cSourceAddr
     out << "  \"i2cSourceAddr\": \"" << Escape(c.i2cSourceAddr) << "\",\n";
 
+    // controls
+    out << "  \"controls\": [";
+    for (size_t i = 0; i < c.controls.size(); ++i) {
+        const auto& ct = c.controls[i];
+        out << (i ? ",\n    " : "\n    ");
+        out << "{\"label\": \"" << Escape(ct.label) << "\", \"code\": \"" << Escape(ct.code) << "\", \"step\": " << ct.step
+            << ", \"up\": \"" << Escape(ct.up) << "\", \"down\": \"" << Escape(ct.down) << "\"}";
+    }
+    out << (c.controls.empty() ? "],\n" : "\n  ],\n");
+    out << "  \"controlI2cAddr\": \"" << Escape(c.controlI2cAddr) << "\",\n";
+
+    // scenes
+    out << "  \"scenes\": [";
+    for (size_t i = 0; i < c.scenes.size(); ++i) {
+        const auto& sc = c.scenes[i];
+        out << (i ? ",\n    " : "\n    ");
+        out << "{\"name\": \"" << Escape(sc.name) << "\", \"input\": \"" << Escape(sc.input) << "\", \"values\": [";
+        for (size_t v = 0; v < sc.values.size(); ++v) {
+            if (v) out << ", ";
+            out << "{\"code\": \"" << Escape(sc.values[v].code) << "\", \"value\": " << sc.values[v].value << "}";
+        }
+        out << "], \"hotkey\": \"" << Escape(sc.hotkey) << "\"}";
+    }
+    out << (c.scenes.empty() ? "],\n" : "\n  ],\n");
+
     // hotkeys
     out << "  \"hotkeys\": {\n";
     out << "    \"cycle\": \"" << Escape(c.hotkeys.cycle) << "\",\n";
@@ -117,6 +195,8 @@ static std::string ToJson(const AppConfig& c) {
 
     // misc
     out << "  \"debounceMs\": " << c.debounceMs << ",\n";
+    out << "  \"settleTimeoutMs\": " << c.settleTimeoutMs << ",\n";
+    out << "  \"coalesceCycle\": " << (c.coalesceCycle ? "true" : "false") << ",\n";
     out << "  \"showNotifications\": " << (c.showNotifications ? "true" : "false") << ",\n";
     out << "  \"startWithWindows\": " << (c.startWithWindows ? "true" : "false") << "\n";
 
@@ -124,6 +204,26 @@ static std::string ToJson(const AppConfig& c) {
     return out.str();
 }
 
+// Biggest config.json we'll parse; a real one is a few KB
+static const std::uintmax_t CONFIG_MAX_BYTES = 1 << 20;
+
+// Integer clamped to [lo, hi] whatever its size in the file (get<int> would wrap it).
+// v must be a number.
+static long long ClampedInt(const json& v, long long lo, long long hi) {
+    long long x;
+    if (v.is_number_unsigned()) x = (long long)std::min<std::uint64_t>(v.get<std::uint64_t>(), (std::uint64_t)hi);
+    else if (v.is_number_integer()) x = v.get<long long>();
+    else x = (long long)std::max<double>(std::min<double>(v.get<double>(), (double)hi), (double)lo);
+    return std::min(std::max(x, lo), hi);
+}
+
+// Unsigned integer that fits in max, or false
+static bool UIntUpTo(const json& v, std::uint64_t max, std::uint64_t& out) {
+    if (!v.is_number_unsigned() || v.get<std::uint64_t>() > max) return false;
+    out = v.get<std::uint64_t>();
+    return true;
+}
+
 static bool ParseJsonToConfig(const json& j, AppConfig& out) {
     try {
         AppConfig c = Defaults();
@@ -132,13 +232,69 @@ static bool ParseJsonToConfig(const json& j, AppConfig& out) {
         if (j.contains("targets") && j["targets"].is_array() && !j["targets"].empty()) {
             c.targets.clear();
             for (auto& t : j["targets"]) {
-                if (t.is_array() && t.size() == 2 && t[0].is_number_integer() && t[1].is_number_integer()) {
-                    c.targets.emplace_back(t[0].get<int>(), t[1].get<int>());
+                // Older configs: [adapter, display]
+                std::uint64_t a = 0, d = 0;
+                if (t.is_array() && t.size() == 2 && UIntUpTo(t[0], INT32_MAX, a) && UIntUpTo(t[1], INT32_MAX, d)) {
+                    c.targets.push_back(Target{ (int)a, (int)d });
+                    continue;
                 }
+                if (!t.is_object() || !t.contains("adapter") || !t.contains("display") ||
+                    !UIntUpTo(t["adapter"], INT32_MAX, a) || !UIntUpTo(t["display"], INT32_MAX, d))
+                    continue;
+                Target tg{ (int)a, (int)d };
+                std::uint64_t u = 0;
+                if (t.contains("manufacturer") && t["manufacturer"].is_string()) {
+                    // A PNP ID is three ASCII letters; cutting anything else could split a UTF-8 sequence
+                    tg.id.manufacturer = t["manufacturer"].get<std::string>().substr(0, 3);
+                    if (std::any_of(tg.id.manufacturer.begin(), tg.id.manufacturer.end(),
+                            [](char ch) { return (unsigned char)ch >= 0x80; }))
+                        tg.id.manufacturer.clear();
+                }
+                if (t.contains("product") && UIntUpTo(t["product"], 0xFFFF, u))
+                    tg.id.product = (unsigned short)u;
+                if (t.contains("serial") && UIntUpTo(t["serial"], 0xFFFFFFFF, u))
+                    tg.id.serial = (unsigned int)u;
+                if (t.contains("serialText") && t["serialText"].is_string())
+                    tg.id.serialText = t["serialText"].get<std::string>();
+                if (t.contains("latency") && t["latency"].is_object()) {
+                    auto& l = t["latency"];
+                    if (l.contains("ewmaMs") && l["ewmaMs"].is_number())
+                        tg.latency.ewmaMs = (double)ClampedInt(l["ewmaMs"], 0, DDC_LATENCY_MAX_MS);
+                    if (l.contains("samples") && l["samples"].is_number_unsigned())
+                        tg.latency.samples = (unsigned int)ClampedInt(l["samples"], 0, UINT32_MAX);
+                    if (l.contains("recent") && l["recent"].is_array()) {
+                        for (auto& r : l["recent"])
+                            if (UIntUpTo(r, DDC_LATENCY_MAX_MS, u)) tg.latency.recent.push_back((unsigned int)u);
+                        if (tg.latency.recent.size() > DDC_LATENCY_RING)
+                            tg.latency.recent.erase(tg.latency.recent.begin(),
+                                tg.latency.recent.end() - DDC_LATENCY_RING);
+                    }
+                    if (tg.latency.recent.empty()) tg.latency.samples = 0;
+                }
+                c.targets.push_back(tg);
             }
             if (c.targets.empty()) c.targets = Defaults().targets;
         }
 
+        // groups (members must point at an existing target)
+        if (j.contains("groups") && j["groups"].is_array()) {
+            for (auto& g : j["groups"]) {
+                if (!g.is_object() || !g.contains("name") || !g["name"].is_string()) continue;
+                TargetGroup tg;
+                tg.name = g["name"].get<std::string>();
+                if (g.contains("targets") && g["targets"].is_array()) {
+                    for (auto& m : g["targets"]) {
+                        std::uint64_t idx = 0;
+                        if (UIntUpTo(m, c.targets.size() - 1, idx))
+                            tg.members.push_back((int)idx);
+                    }
+                }
+                if (!tg.members.empty()) c.groups.push_back(std::move(tg));
+            }
+        }
+        if (j.contains("activeGroup") && j["activeGroup"].is_string())
+            c.activeGroup = j["activeGroup"].get<std::string>();
+
         // inputs
         if (j.contains("inputs") && j["inputs"].is_array() && !j["inputs"].empty()) {
             c.inputs.clear();
@@ -162,6 +318,46 @@ static bool ParseJsonToConfig(const json& j, AppConfig& out) {
             c.i2cSourceAddr = j["i2cSourceAddr"].get<std::string>();
         }
 
+        // controls (an empty array turns them all off)
+        if (j.contains("controls") && j["controls"].is_array()) {
+            c.controls.clear();
+            for (auto& ct : j["controls"]) {
+                if (!ct.is_object() || !ct.contains("label") || !ct.contains("code") ||
+                    !ct["label"].is_string() || !ct["code"].is_string())
+                    continue;
+                ControlDef d;
+                d.label = ct["label"].get<std::string>();
+                d.code = ct["code"].get<std::string>();
+                if (ct.contains("step") && ct["step"].is_number_integer())
+                    d.step = (int)ClampedInt(ct["step"], 1, 0xFFFF);
+                if (ct.contains("up") && ct["up"].is_string()) d.up = ct["up"].get<std::string>();
+                if (ct.contains("down") && ct["down"].is_string()) d.down = ct["down"].get<std::string>();
+                c.controls.push_back(std::move(d));
+            }
+        }
+        if (j.contains("controlI2cAddr") && j["controlI2cAddr"].is_string())
+            c.controlI2cAddr = j["controlI2cAddr"].get<std::string>();
+
+        // scenes
+        if (j.contains("scenes") && j["scenes"].is_array()) {
+            for (auto& sc : j["scenes"]) {
+                if (!sc.is_object() || !sc.contains("name") || !sc["name"].is_string()) continue;
+                SceneDef d;
+                d.name = sc["name"].get<std::string>();
+                if (sc.contains("input") && sc["input"].is_string()) d.input = sc["input"].get<std::string>();
+                if (sc.contains("hotkey") && sc["hotkey"].is_string()) d.hotkey = sc["hotkey"].get<std::string>();
+                if (sc.contains("values") && sc["values"].is_array()) {
+                    for (auto& v : sc["values"]) {
+                        std::uint64_t value = 0;
+                        if (v.is_object() && v.contains("code") && v["code"].is_string() &&
+                            v.contains("value") && UIntUpTo(v["value"], 0xFFFF, value))
+                            d.values.push_back({ v["code"].get<std::string>(), (unsigned int)value });
+                    }
+                }
+                if (!d.input.empty() || !d.values.empty()) c.scenes.push_back(std::move(d));
+            }
+        }
+
         // hotkeys.cycle
         if (j.contains("hotkeys") && j["hotkeys"].is_object()) {
             auto& hk = j["hotkeys"];
@@ -178,7 +374,11 @@ static bool ParseJsonToConfig(const json& j, AppConfig& out) {
 
         // misc
         if (j.contains("debounceMs") && j["debounceMs"].is_number_integer())
-            c.debounceMs = j["debounceMs"].get<int>();
+            c.debounceMs = (int)ClampedInt(j["debounceMs"], 0, 60000);
+        if (j.contains("settleTimeoutMs") && j["settleTimeoutMs"].is_number_integer())
+            c.settleTimeoutMs = (int)ClampedInt(j["settleTimeoutMs"], 0, 60000);
+        if (j.contains("coalesceCycle") && j["coalesceCycle"].is_boolean())
+            c.coalesceCycle = j["coalesceCycle"].get<bool>();
         if (j.contains("showNotifications") && j["showNotifications"].is_boolean())
             c.showNotifications = j["showNotifications"].get<bool>();
         if (j.contains("startWithWindows") && j["startWithWindows"].is_boolean())
@@ -194,6 +394,47 @@ static bool ParseJsonToConfig(const json& j, AppConfig& out) {
 
 // ---------- Public API ----------
 
+std::string ConfigToJson(const AppConfig& cfg) {
+    return ToJson(cfg);
+}
+
+bool ConfigFromJson(const std::string& text, AppConfig& out) {
+    try {
+        nlohmann::json j = nlohmann::json::parse(text);
+        return ParseJsonToConfig(j, out);
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+std::vector<InputDef> OrderedInputs(const AppConfig& cfg) {
+    // Build map of enabled inputs
+    std::map<std::string, const InputDef*> enabled;
+    for (auto& in : cfg.inputs) enabled[in.label] = &in;
+
+    std::vector<InputDef> out;
+    std::set<std::string> used;
+
+    // 1) take items from cycleOrder that are enabled
+    for (auto& name : cfg.cycleOrder) {
+        auto it = enabled.find(name);
+        if (it != enabled.end()) {
+            out.push_back(*it->second);
+            used.insert(name);
+        }
+    }
+    // 2) append remaining enabled inputs
+    for (auto& kv : enabled) {
+        if (!used.count(kv.first)) out.push_back(*kv.second);
+    }
+    // fallback
+    if (out.empty()) {
+        for (auto& in : cfg.inputs) out.push_back(in);
+    }
+    return out;
+}
+
 bool LoadConfig(AppConfig& out) {
     const auto path = ConfigPath();
     if (!std::filesystem::exists(path)) {
@@ -204,8 +445,10 @@ bool LoadConfig(AppConfig& out) {
     }
 
     // Read file
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(path, ec);
     std::ifstream f(path, std::ios::binary);
-    if (!f) {
+    if (!f || ec || size > CONFIG_MAX_BYTES) {
         out = Defaults();
         return false;
     }
@@ -213,14 +456,7 @@ bool LoadConfig(AppConfig& out) {
     f.close();
 
     // Parse JSON
-    try {
-        nlohmann::json j = nlohmann::json::parse(ss.str());
-        if (!ParseJsonToConfig(j, out)) {
-            out = Defaults();
-            return false;
-        }
-    }
-    catch (...) {
+    if (!ConfigFromJson(ss.str(), out)) {
         out = Defaults();
         return false;
     }
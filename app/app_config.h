@@ -9,13 +9,39 @@ struct HotkeysCfg {
     std::map<std::string, std::string> direct; // label -> hotkey
 };
 
+// Displays that switch together: one hotkey drives every member concurrently
+struct TargetGroup {
+    std::string name;
+    std::vector<int> members; // indices into AppConfig::targets
+};
+
+// One action that sets several VCP values and (optionally) the input on the active targets
+struct SceneValueDef {
+    std::string code;        // VCP code, e.g. "0x10"
+    unsigned int value = 0;
+};
+
+struct SceneDef {
+    std::string name;                  // e.g. "Laptop"
+    std::string input;                 // label from AppConfig::inputs; empty = leave the input alone
+    std::vector<SceneValueDef> values; // written in this order, before the input
+    std::string hotkey;                // empty = menu only
+};
+
 struct AppConfig {
-    std::vector<std::pair<int, int>> targets; // {adapter, display} (use first)
+    std::vector<Target> targets;             // first is the default target
+    std::vector<TargetGroup> groups;
+    std::string activeGroup;                 // empty: hotkeys drive targets[0] only
     std::vector<InputDef> inputs;            // available inputs
     std::vector<std::string> cycleOrder;     // ordered labels
     std::string i2cSourceAddr = "0x50";
+    std::vector<ControlDef> controls;        // brightness / contrast / volume hotkeys
+    std::string controlI2cAddr = "0x51";     // standard DDC/CI subaddress for the controls (and scene values)
+    std::vector<SceneDef> scenes;
     HotkeysCfg hotkeys;
     int debounceMs = 750;
+    bool coalesceCycle = true;               // cycle presses during a switch only move the pending target
+    int settleTimeoutMs = 700;               // max wait for the monitor to confirm a switch
     bool showNotifications = true;
     bool startWithWindows = false;
 };
@@ -24,3 +50,10 @@ std::string ConfigPath();
 bool EnsureConfigDir();
 bool LoadConfig(AppConfig& out);
 bool SaveConfig(const AppConfig& cfg);
+
+// config.json text <-> AppConfig without touching the file (LoadConfig / SaveConfig use these)
+std::string ConfigToJson(const AppConfig& cfg);
+bool ConfigFromJson(const std::string& text, AppConfig& out);
+
+// Inputs in cycle order: cycleOrder first, then any others by label
+std::vector<InputDef> OrderedInputs(const AppConfig& cfg);
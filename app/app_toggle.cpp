@@ -1,32 +1,167 @@
 ﻿#include "app_toggle.h"
+#include "ddc_coalesce.h"
+#include "ddc_identity.h"
+#include "ddc_reply.h"
+#include "ddc_retry.h"
+#include "display_service.h"
 #include <windows.h>
 #include <cstdlib>
-#include "amdddc_core.h"
+#include <functional>
+#include <iterator>
+#include <map>
+#include <thread>
+#include <utility>
 
 static unsigned int ParseHex(const std::string& s) {
     return strtoul(s.c_str(), nullptr, 0);
 }
 
-bool SendInputCode(const Target& t, const char* i2cAddrHex, const char* codeHex) {
+// Where each display is right now; cached, so this only walks the displays after a miss.
+// found[i] is 0 when target i has an identity that isn't connected: its stored indices
+// may now belong to another monitor, so it must not be written to.
+static std::vector<Target> ResolveTargets(const std::vector<Target>& targets, std::vector<char>& found) {
+    std::vector<Target> resolved(targets);
+    found.assign(targets.size(), 1);
+    for (size_t i = 0; i < resolved.size(); ++i) {
+        Target& t = resolved[i];
+        if (t.id.Valid() && !ResolveDisplay(t.id, t.adapterIndex, t.displayIndex)) found[i] = 0;
+    }
+    return resolved;
+}
+
+static void MarkNotConnected(DdcSwitchResult& r) {
+    r.rc = DDC_ERR_NOT_CONNECTED;
+    r.errorClass = (int)ClassifyDdcError(r.rc);
+}
+
+// Runs fn(i) for every target: concurrently across DDC buses, in order within one
+static void RunPerBus(const std::vector<Target>& resolved, const std::function<void(size_t)>& fn) {
+    // Each {adapter, display} is its own DDC bus; entries on the same bus run in order
+    std::map<std::pair<int, int>, std::vector<size_t>> buses;
+    for (size_t i = 0; i < resolved.size(); ++i)
+        buses[{ resolved[i].adapterIndex, resolved[i].displayIndex }].push_back(i);
+    if (buses.empty()) return;
+
+    auto runBus = [&](const std::vector<size_t>& members) {
+        for (size_t i : members) fn(i);
+    };
+
+    // Workers for all buses but one; the calling thread takes the last
+    std::vector<std::thread> workers;
+    auto last = std::prev(buses.end());
+    for (auto it = buses.begin(); it != last; ++it)
+        workers.emplace_back(runBus, std::cref(it->second));
+    runBus(last->second);
+    for (auto& w : workers) w.join();
+}
+
+static void CollectProfiles(const std::vector<Target>& resolved, const std::vector<char>& found,
+    std::vector<DdcLatencyProfile>& out) {
+    for (size_t i = 0; i < resolved.size(); ++i)
+        if (found[i]) GetLatencyProfile(resolved[i].adapterIndex, resolved[i].displayIndex, out[i]);
+}
+
+bool SendInputCode(const Target& t, const char* i2cAddrHex, const char* codeHex,
+    DdcSwitchResult* outResult) {
     // For this AMD+LG path, the CLI used a fixed side-channel code (0xF4) and put the input
     // in the "value" field. We mirror that here and pass i2c subaddress (0x50) from config.
-    const unsigned short DUMMY_VCP = 0xF4; // ignored in our core; kept for clarity
+    const unsigned short LG_INPUT_VCP = 0xF4; // LG's input-select code on the 0x50 side channel; sent as-is
     unsigned int value = ParseHex(codeHex);     // e.g., 0xD0 / 0xD1 / 0x90 / 0x91
     unsigned int i2c = ParseHex(i2cAddrHex);  // e.g., 0x50
 
-    int rc = SetVcpFeatureWithI2cAddr(
+    // The core keeps learning from here; the saved profile only matters on a fresh start
+    SeedLatencyProfile(t.adapterIndex, t.displayIndex, t.latency);
+
+    int rc = SetVcpFeatureWithI2cAddrEx(
         t.adapterIndex,
         t.displayIndex,
-        DUMMY_VCP,
+        LG_INPUT_VCP,
         value,
-        i2c
+        i2c,
+        t.settleDeadlineMs,
+        outResult
     );
     return rc == 0;
 }
 
-bool ToggleCycle(const Target& t, const char* i2cAddrHex,
-    const std::vector<InputDef>& orderedInputs, int& idx) {
-    if (orderedInputs.empty()) return false;
-    idx = (idx + 1) % (int)orderedInputs.size();
-    return SendInputCode(t, i2cAddrHex, orderedInputs[idx].code.c_str());
+bool SendInputCodeToGroup(const std::vector<Target>& targets, const char* i2cAddrHex, const char* codeHex,
+    std::vector<DdcSwitchResult>& outResults, std::vector<DdcLatencyProfile>* outProfiles) {
+    outResults.assign(targets.size(), DdcSwitchResult{});
+    if (outProfiles) outProfiles->assign(targets.size(), DdcLatencyProfile{});
+    if (targets.empty()) return false;
+
+    std::vector<char> found;
+    const std::vector<Target> resolved = ResolveTargets(targets, found);
+    std::vector<char> ok(targets.size(), 0);
+    RunPerBus(resolved, [&](size_t i) {
+        if (!found[i]) {
+            MarkNotConnected(outResults[i]);
+            return;
+        }
+        ok[i] = SendInputCode(resolved[i], i2cAddrHex, codeHex, &outResults[i]) ? 1 : 0;
+    });
+    if (outProfiles) CollectProfiles(resolved, found, *outProfiles);
+
+    for (char b : ok) if (!b) return false;
+    return true;
+}
+
+bool ApplySceneToGroup(const std::vector<Target>& targets, const char* inputI2cHex, const char* inputCodeHex,
+    const char* valueI2cHex, const std::vector<DdcSceneValue>& values,
+    std::vector<DdcSceneResult>& outResults, std::vector<DdcLatencyProfile>* outProfiles) {
+    outResults.assign(targets.size(), DdcSceneResult{});
+    if (outProfiles) outProfiles->assign(targets.size(), DdcLatencyProfile{});
+    if (targets.empty()) return false;
+
+    std::vector<char> found;
+    const std::vector<Target> resolved = ResolveTargets(targets, found);
+    std::vector<char> ok(targets.size(), 0);
+    RunPerBus(resolved, [&](size_t i) {
+        if (!found[i]) {
+            MarkNotConnected(outResults[i].input);
+            outResults[i].rc = outResults[i].input.rc;
+            return;
+        }
+        const Target& t = resolved[i];
+        DdcScene scene;
+        scene.values = values;
+        scene.valueSubaddress = ParseHex(valueI2cHex);
+        scene.hasInput = inputCodeHex && *inputCodeHex;
+        if (scene.hasInput) {
+            scene.inputValue = ParseHex(inputCodeHex);
+            scene.inputSubaddress = ParseHex(inputI2cHex);
+            SeedLatencyProfile(t.adapterIndex, t.displayIndex, t.latency);
+        }
+        scene.settleDeadlineMs = t.settleDeadlineMs;
+        ok[i] = RunDdcScene(t.adapterIndex, t.displayIndex, scene, outResults[i]) == 0 ? 1 : 0;
+    });
+    if (outProfiles) CollectProfiles(resolved, found, *outProfiles);
+
+    for (char b : ok) if (!b) return false;
+    return true;
+}
+
+void AdjustVcpControl(const std::vector<Target>& targets, const char* i2cAddrHex, const char* codeHex, int delta) {
+    const unsigned int i2c = ParseHex(i2cAddrHex);
+    const unsigned char code = (unsigned char)ParseHex(codeHex);
+
+    // Key repeats arrive on the UI thread: look displays up in memory, never walk the adapters
+    const DisplaySnapshot snap = GetDisplaySnapshot();
+    for (const auto& t : targets) {
+        int a = t.adapterIndex, d = t.displayIndex;
+        if (t.id.Valid()) {
+            bool seen = false;
+            for (const auto& disp : snap.displays) {
+                if (disp.id != t.id) continue;
+                seen = true;
+                a = disp.adapterIdx;
+                d = disp.displayIdx;
+                if (a == t.adapterIndex && d == t.displayIndex) break; // prefer where it was last seen
+            }
+            // Before the first walk the stored indices are all there is; after it, a missing
+            // identity means another monitor may sit at those indices now
+            if (!seen && snap.generation != 0) continue;
+        }
+        SubmitVcpStep(a, d, i2c, code, delta);
+    }
 }
@@ -2,8 +2,28 @@
 #include <string>
 #include <vector>
 #include "types.h"
+#include "amdddc_core.h"
+#include "ddc_scene.h"
 
-bool SendInputCode(const Target& t, const char* i2cAddrHex, const char* codeHex);
-bool ToggleCycle(const Target& t, const char* i2cAddrHex,
-    const std::vector<InputDef>& orderedInputs,
-    int& inOutIndex);
+// outResult (optional) receives the write status and the observed switch latency.
+bool SendInputCode(const Target& t, const char* i2cAddrHex, const char* codeHex,
+    DdcSwitchResult* outResult = nullptr);
+
+// Switches every target to the same input concurrently, one worker per DDC bus, so a
+// group costs its slowest display instead of the sum. outResults[i] belongs to targets[i].
+// outProfiles (optional) receives each display's learned latency after the switch, for
+// persisting. Returns true only if every display switched.
+bool SendInputCodeToGroup(const std::vector<Target>& targets, const char* i2cAddrHex, const char* codeHex,
+    std::vector<DdcSwitchResult>& outResults, std::vector<DdcLatencyProfile>* outProfiles = nullptr);
+
+// Applies a scene to every target, one worker per DDC bus like SendInputCodeToGroup: the
+// values first at minimum bus spacing, then the input (empty inputCodeHex = no input
+// change), which alone waits for confirmation. outResults[i] belongs to targets[i].
+bool ApplySceneToGroup(const std::vector<Target>& targets, const char* inputI2cHex, const char* inputCodeHex,
+    const char* valueI2cHex, const std::vector<DdcSceneValue>& values,
+    std::vector<DdcSceneResult>& outResults, std::vector<DdcLatencyProfile>* outProfiles = nullptr);
+
+// Steps a continuous control (brightness, contrast, volume) on every target by delta.
+// Hands the step to the coalescer (ddc_coalesce.h), so it returns at once and key repeats
+// collapse into the latest value. Displays are located from the display service's snapshot.
+void AdjustVcpControl(const std::vector<Target>& targets, const char* i2cAddrHex, const char* codeHex, int delta);
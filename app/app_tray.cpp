@@ -1,39 +1,83 @@
 #include "app_tray.h"
 #include "app_config.h"
 #include "app_toggle.h"
+#include "ddc_coalesce.h"
+#include "ddc_identity.h"
+#include "ddc_metrics.h"
+#include "ddc_reply.h"
+#include "ddc_retry.h"
+#include "ddc_trace.h"
+#include "ddc_transport.h"
+#include "display_service.h"
 #include "hotkeys.h"
 #include "util.h"
 #include "settings_ui.h"
+#include "switch_queue.h"
 #include "welcome_ui.h"
 #include "../resource/resource.h"
 
 #include <windows.h>
 #include <shellapi.h>
+#include <dbt.h>
 #include <vector>
 #include <map>
 #include <chrono>
-#include <set>
+#include <cstdlib>
+#include <filesystem>
 
 static const wchar_t* kWndClass = L"LGInputSwitchHiddenWnd";
 static UINT HKID_CYCLE = 1;
 static std::map<UINT, std::string> g_directById;
+// Control hotkeys (ids from 200): index into g_cfg.controls and direction
+static std::map<UINT, std::pair<size_t, int>> g_controlById;
+// Scene hotkeys (ids from 300): index into g_cfg.scenes
+static std::map<UINT, size_t> g_sceneById;
 static int g_cycleIndex = -1;
 static std::chrono::steady_clock::time_point g_lastPress;
 
+// Cycle coalescing (UI thread only): while a cycle switch is queued or running, further
+// presses just advance g_cycleIndex; the latest target is written once the bus is free.
+static bool g_cycleInFlight = false;
+static bool g_cyclePending = false;
+
 static NOTIFYICONDATA nid{};
 static AppConfig g_cfg;
-static Target g_target;
+static std::vector<Target> g_targets; // displays driven by hotkeys/menu (active group)
+
+// Learned switch latencies not yet written to config.json
+static const int LATENCY_SAVE_INTERVAL_S = 60;
+static bool g_latencyDirty = false;
+static std::chrono::steady_clock::time_point g_lastLatencySave;
+
+// Latency histograms, per-display counters and the switch queue depth (ddc_metrics.h), dumped
+// for `amdddc-windows stats`
+static const int METRICS_SAVE_INTERVAL_S = 60;
+static std::chrono::steady_clock::time_point g_lastMetricsSave;
+
+// Startup phases go into the same dump: transportOpen, loadConfig, trayReady (from RunTrayApp)
+static std::chrono::steady_clock::time_point g_startedAt;
 
 // Dynamic input menu id range
 static const UINT ID_INPUT_BASE = 41000;
 static std::map<UINT, size_t> g_menuInputIdToIndex; // menu id -> index into g_cfg.inputs
 
+// Dynamic group menu id range ("" = first target only)
+static const UINT ID_GROUP_BASE = 42000;
+static std::map<UINT, std::string> g_menuGroupIdToName;
+
+// Dynamic scene menu id range
+static const UINT ID_SCENE_BASE = 43000;
+static std::map<UINT, size_t> g_menuSceneIdToIndex; // menu id -> index into g_cfg.scenes
+
 // Message posted by settings dialog when user saves
 static const UINT WM_SETTINGS_SAVED = WM_APP + 2;
 
+// Posted by the switch worker when a queued switch finishes (lParam = SwitchCompletion*)
+static const UINT WM_SWITCH_DONE = WM_APP + 3;
+
 static void UnregisterAllHotkeys(HWND hwnd) {
     UnregisterHotKey(hwnd, HKID_CYCLE);
-    for (UINT id = 100; id < 200; ++id) UnregisterHotKey(hwnd, id);
+    for (UINT id = 100; id < 400; ++id) UnregisterHotKey(hwnd, id);
 }
 
 static void Balloon(const wchar_t* msg) {
@@ -44,6 +88,170 @@ static void Balloon(const wchar_t* msg) {
     Shell_NotifyIcon(NIM_MODIFY, &nid);
 }
 
+// Balloon for a completed switch; shows the monitor-confirmed latency when there is one.
+// For a group the latency is the slowest display, since they switch concurrently.
+static void SwitchedBalloon(const std::string& label, const std::vector<DdcSwitchResult>& results) {
+    std::wstring msg = ToW(label);
+    bool allActive = !results.empty(), anyConfirmed = false, anyMismatch = false;
+    unsigned int maxMs = 0;
+    for (const auto& r : results) {
+        allActive = allActive && r.alreadyActive;
+        anyMismatch = anyMismatch || r.errorClass == (int)DdcErrorClass::mismatch;
+        if (r.confirmed && !r.alreadyActive) {
+            anyConfirmed = true;
+            if (r.latencyMs > maxMs) maxMs = r.latencyMs;
+        }
+    }
+    if (results.size() > 1) msg += L" on " + std::to_wstring(results.size()) + L" displays";
+    if (allActive) msg += L" (already active)";
+    else if (anyMismatch) msg += L" (not confirmed by monitor)";
+    else if (anyConfirmed) msg += L" (" + std::to_wstring(maxMs) + L" ms)";
+    Balloon(msg.c_str());
+}
+
+// What the retry engine concluded, in words a user can act on
+static std::wstring FailureReason(const DdcSwitchResult& r) {
+    if (r.rc == DDC_ERR_NOT_CONNECTED) return L"display not connected";
+    switch ((DdcErrorClass)r.errorClass) {
+    case DdcErrorClass::busy:
+        return L"monitor busy";
+    case DdcErrorClass::transient:
+        return L"no response after " + std::to_wstring(r.attempts) + L" attempts";
+    case DdcErrorClass::fatal:
+        return L"check I2C/target";
+    default:
+        return L"error " + std::to_wstring(r.rc);
+    }
+}
+
+static void FailedBalloon(const std::vector<DdcSwitchResult>& results) {
+    size_t failed = 0;
+    const DdcSwitchResult* firstFailure = nullptr;
+    for (const auto& r : results) {
+        if (r.rc == 0) continue;
+        ++failed;
+        if (!firstFailure) firstFailure = &r;
+    }
+    const std::wstring reason = firstFailure ? FailureReason(*firstFailure) : L"check I2C/target";
+    if (results.size() > 1) {
+        std::wstring msg = L"Switch failed on " + std::to_wstring(failed) + L" of " +
+            std::to_wstring(results.size()) + L" displays (" + reason + L")";
+        Balloon(msg.c_str());
+    } else {
+        std::wstring msg = L"Switch failed (" + reason + L")";
+        Balloon(msg.c_str());
+    }
+}
+
+// Scene balloon: total time is the slowest display's, values and input switch included
+static void SceneBalloon(const SwitchCompletion& done) {
+    std::wstring msg = L"Scene " + ToW(done.job.label);
+    if (!done.ok) {
+        const DdcSceneResult* firstFailure = nullptr;
+        for (const auto& r : done.sceneResults)
+            if (r.rc != 0 && !firstFailure) firstFailure = &r;
+        msg += L" failed";
+        if (firstFailure && firstFailure->input.rc != 0) msg += L" (" + FailureReason(firstFailure->input) + L")";
+        else msg += L" (a value was not accepted)";
+        Balloon(msg.c_str());
+        return;
+    }
+    unsigned int maxMs = 0;
+    for (const auto& r : done.sceneResults)
+        if (r.totalMs > maxMs) maxMs = r.totalMs;
+    if (done.sceneResults.size() > 1) msg += L" on " + std::to_wstring(done.sceneResults.size()) + L" displays";
+    msg += L" (" + std::to_wstring(maxMs) + L" ms)";
+    Balloon(msg.c_str());
+}
+
+// Hand a switch to the I/O worker; the result comes back as WM_SWITCH_DONE
+static void QueueSwitch(const InputDef& in, int inputIndex, bool cycle) {
+    SwitchJob job;
+    job.targets = g_targets;
+    job.i2cAddr = g_cfg.i2cSourceAddr;
+    job.code = in.code;
+    job.label = in.label;
+    job.inputIndex = inputIndex;
+    job.cycle = cycle;
+    EnqueueSwitch(std::move(job));
+}
+
+// Copy what the core learned about each display's switch latency back into g_cfg.
+// Written out at most once a minute (and on exit): it's a hint, not worth a disk write per switch.
+static void StoreLatencyProfiles(const SwitchCompletion& done) {
+    for (size_t i = 0; i < done.profiles.size() && i < done.job.targets.size(); ++i) {
+        const int ci = done.job.targets[i].configIndex;
+        if (ci < 0 || ci >= (int)g_cfg.targets.size() || !done.profiles[i].samples) continue;
+        if (done.profiles[i].samples == g_cfg.targets[ci].latency.samples) continue;
+        g_cfg.targets[ci].latency = done.profiles[i];
+        g_latencyDirty = true;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (g_latencyDirty && now - g_lastLatencySave >= std::chrono::seconds(LATENCY_SAVE_INTERVAL_S)) {
+        SaveConfig(g_cfg);
+        g_latencyDirty = false;
+        g_lastLatencySave = now;
+    }
+}
+
+// Diagnostics files live next to config.json
+static std::string BesideConfig(const char* name) {
+    return (std::filesystem::path(ConfigPath()).parent_path() / name).string();
+}
+
+static std::uint64_t MsSince(std::chrono::steady_clock::time_point from) {
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - from).count();
+}
+
+static void SaveMetrics(bool force) {
+    const auto now = std::chrono::steady_clock::now();
+    if (!force && now - g_lastMetricsSave < std::chrono::seconds(METRICS_SAVE_INTERVAL_S)) return;
+    const SwitchQueueStats queue = GetSwitchQueueStats();
+    SetDdcGauge("queueDepth", (std::uint64_t)queue.depth);
+    SetDdcGauge("queueMaxDepth", (std::uint64_t)queue.maxDepth);
+    WriteDdcMetricsFile(BesideConfig("ddc-metrics.json"));
+    g_lastMetricsSave = now;
+}
+
+// Scenes go through the same worker as switches, so they never interleave with one
+static void QueueScene(const SceneDef& sc) {
+    SwitchJob job;
+    job.targets = g_targets;
+    job.i2cAddr = g_cfg.i2cSourceAddr;
+    job.valueI2cAddr = g_cfg.controlI2cAddr;
+    job.label = sc.name;
+    job.scene = true;
+    for (size_t i = 0; i < g_cfg.inputs.size() && !sc.input.empty(); ++i) {
+        if (g_cfg.inputs[i].label != sc.input) continue;
+        job.code = g_cfg.inputs[i].code;
+        job.inputIndex = (int)i;
+        break;
+    }
+    for (const auto& v : sc.values)
+        job.values.push_back({ (unsigned char)strtoul(v.code.c_str(), nullptr, 0), v.value });
+    if (job.code.empty() && job.values.empty()) return;
+    EnqueueSwitch(std::move(job));
+}
+
+// Targets of the active group, or just the first target when no group is active
+static std::vector<Target> TargetsFromConfig(const AppConfig& c) {
+    std::vector<int> members;
+    for (const auto& g : c.groups)
+        if (!c.activeGroup.empty() && g.name == c.activeGroup) members = g.members;
+    if (members.empty()) members.push_back(0);
+
+    std::vector<Target> out;
+    for (int m : members) {
+        if (m < 0 || m >= (int)c.targets.size()) continue;
+        Target t = c.targets[m];
+        t.settleDeadlineMs = (unsigned int)c.settleTimeoutMs;
+        t.configIndex = m;
+        out.push_back(t);
+    }
+    return out;
+}
+
 static HMENU Menu() {
     HMENU h = CreatePopupMenu();
 
@@ -61,6 +269,36 @@ static HMENU Menu() {
         AppendMenu(h, MF_STRING, id, label.c_str());
     }
 
+    // Scenes (only when configured)
+    g_menuSceneIdToIndex.clear();
+    if (!g_cfg.scenes.empty()) {
+        HMENU sub = CreatePopupMenu();
+        for (size_t i = 0; i < g_cfg.scenes.size(); ++i) {
+            UINT id = ID_SCENE_BASE + (UINT)i;
+            g_menuSceneIdToIndex[id] = i;
+            std::wstring label = ToW(g_cfg.scenes[i].name);
+            AppendMenu(sub, MF_STRING, id, label.c_str());
+        }
+        AppendMenu(h, MF_SEPARATOR, 0, nullptr);
+        AppendMenu(h, MF_POPUP, (UINT_PTR)sub, L"Scenes");
+    }
+
+    // Group selection (only when groups are configured)
+    g_menuGroupIdToName.clear();
+    if (!g_cfg.groups.empty()) {
+        HMENU sub = CreatePopupMenu();
+        UINT id = ID_GROUP_BASE;
+        g_menuGroupIdToName[id] = "";
+        AppendMenu(sub, MF_STRING | (g_cfg.activeGroup.empty() ? MF_CHECKED : 0), id++, L"Default display");
+        for (const auto& g : g_cfg.groups) {
+            g_menuGroupIdToName[id] = g.name;
+            std::wstring label = ToW(g.name);
+            AppendMenu(sub, MF_STRING | (g.name == g_cfg.activeGroup ? MF_CHECKED : 0), id++, label.c_str());
+        }
+        AppendMenu(h, MF_SEPARATOR, 0, nullptr);
+        AppendMenu(h, MF_POPUP, (UINT_PTR)sub, L"Displays");
+    }
+
     // Settings / Exit
     AppendMenu(h, MF_SEPARATOR, 0, nullptr);
     AppendMenu(h, MF_STRING, ID_TRAY_SETTINGS, L"Settings...");
@@ -84,38 +322,42 @@ static void RegisterHK(HWND hwnd) {
                 g_directById[id] = kv.first; // label
         }
     }
-}
 
-static std::vector<InputDef> OrderedInputs() {
-    // Build map of enabled inputs
-    std::map<std::string, const InputDef*> enabled;
-    for (auto& in : g_cfg.inputs) enabled[in.label] = &in;
-
-    std::vector<InputDef> out;
-    std::set<std::string> used;
-
-    // 1) take items from cycleOrder that are enabled
-    for (auto& name : g_cfg.cycleOrder) {
-        auto it = enabled.find(name);
-        if (it != enabled.end()) {
-            out.push_back(*it->second);
-            used.insert(name);
+    // Key repeat is wanted here: holding the key keeps stepping (the coalescer absorbs it)
+    UINT cid = 200;
+    g_controlById.clear();
+    for (size_t i = 0; i < g_cfg.controls.size(); ++i) {
+        const auto& ct = g_cfg.controls[i];
+        const std::pair<const std::string*, int> keys[] = { { &ct.up, +1 }, { &ct.down, -1 } };
+        for (const auto& k : keys) {
+            HotkeySpec h3{};
+            if (cid < 300 && ParseHotkey(*k.first, h3)) {
+                UINT id = cid++;
+                if (RegisterHotKey(hwnd, id, h3.fsModifiers, h3.vk))
+                    g_controlById[id] = { i, k.second };
+            }
         }
     }
-    // 2) append remaining enabled inputs
-    for (auto& kv : enabled) {
-        if (!used.count(kv.first)) out.push_back(*kv.second);
-    }
-    // fallback
-    if (out.empty()) {
-        for (auto& in : g_cfg.inputs) out.push_back(in);
+
+    UINT sid = 300;
+    g_sceneById.clear();
+    for (size_t i = 0; i < g_cfg.scenes.size() && sid < 400; ++i) {
+        HotkeySpec h4{};
+        if (ParseHotkey(g_cfg.scenes[i].hotkey, h4)) {
+            UINT id = sid++;
+            if (RegisterHotKey(hwnd, id, h4.fsModifiers, h4.vk))
+                g_sceneById[id] = i;
+        }
     }
-    return out;
 }
 
 static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_CREATE: {
+        // ADL loads on a background thread while the tray comes up and the config is read.
+        // A hotkey that beats it waits for it in the core rather than loading it again.
+        PrewarmTransport();
+
         // Tray icon (custom)
         nid.cbSize = sizeof(nid);
         nid.hWnd = hwnd;
@@ -127,8 +369,17 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
         wcscpy_s(nid.szTip, L"LGInputSwitch");
         Shell_NotifyIcon(NIM_ADD, &nid);
 
+        // Raw DDC frames go to ddc-trace.bin next to config.json, so a misbehaving switch can be
+        // decoded afterwards (amdddc-windows trace-dump); the last run's stays as .prev
+        OpenDdcTraceFile(BesideConfig("ddc-trace.bin"));
+
+        // Display list for the settings dialog, walked in the background from here on
+        StartDisplayService();
+
         // First-run flow: LoadConfig returns false if file missing/bad
+        const auto configStart = std::chrono::steady_clock::now();
         bool loaded = LoadConfig(g_cfg);
+        RecordDdcPhaseMs("loadConfig", MsSince(configStart));
         if (!loaded) {
             // First-run: show Welcome (modal) and then settings (modal) so user configures before hotkeys
             if (!ShowWelcomeDialog(hwnd) || !ShowSettingsDialogModal(hwnd, g_cfg)) {
@@ -138,25 +389,57 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             SaveConfig(g_cfg);
         }
 
-        if (g_cfg.targets.empty()) g_cfg.targets.push_back({ 5,0 });
-        g_target = { g_cfg.targets[0].first, g_cfg.targets[0].second };
+        if (g_cfg.targets.empty()) g_cfg.targets.push_back(Target{ 5, 0 });
+        g_targets = TargetsFromConfig(g_cfg);
+        StartSwitchQueue(hwnd, WM_SWITCH_DONE);
         RegisterHK(hwnd);
+        // Not on first run: that includes the time spent in the dialogs
+        if (loaded) RecordDdcPhaseMs("trayReady", MsSince(g_startedAt));
         return 0;
     }
     case WM_HOTKEY: {
         auto now = std::chrono::steady_clock::now();
+
+        // Brightness / contrast / volume: no debounce, repeats collapse in the coalescer
+        auto cit = g_controlById.find((UINT)wParam);
+        if (cit != g_controlById.end()) {
+            if (cit->second.first < g_cfg.controls.size()) {
+                const ControlDef& ct = g_cfg.controls[cit->second.first];
+                AdjustVcpControl(g_targets, g_cfg.controlI2cAddr.c_str(), ct.code.c_str(), ct.step * cit->second.second);
+            }
+            return 0;
+        }
+
+        // Coalesced cycle presses replace the debounce: bursts collapse into one switch
+        if (wParam == HKID_CYCLE && g_cfg.coalesceCycle) {
+            auto ord = OrderedInputs(g_cfg);
+            if (ord.empty()) return 0;
+            g_cycleIndex = (g_cycleIndex + 1) % (int)ord.size();
+            if (g_cycleInFlight) {
+                g_cyclePending = true;
+            } else {
+                g_cycleInFlight = true;
+                QueueSwitch(ord[g_cycleIndex], g_cycleIndex, true);
+            }
+            return 0;
+        }
+
         if (std::chrono::duration_cast<std::chrono::milliseconds>(now - g_lastPress).count() < g_cfg.debounceMs)
             return 0;
         g_lastPress = now;
 
         if (wParam == HKID_CYCLE) {
-            auto ord = OrderedInputs();
-            if (ToggleCycle(g_target, g_cfg.i2cSourceAddr.c_str(), ord, g_cycleIndex)) {
-                std::wstring msg = (g_cycleIndex >= 0 && g_cycleIndex < (int)ord.size())
-                    ? ToW(ord[g_cycleIndex].label) : L"Switched";
-                Balloon(msg.c_str());
-            } else {
-                Balloon(L"Switch failed (check I2C/target)");
+            auto ord = OrderedInputs(g_cfg);
+            if (ord.empty()) return 0;
+            g_cycleIndex = (g_cycleIndex + 1) % (int)ord.size();
+            QueueSwitch(ord[g_cycleIndex], g_cycleIndex, true);
+            return 0;
+        }
+        auto sit = g_sceneById.find((UINT)wParam);
+        if (sit != g_sceneById.end()) {
+            if (sit->second < g_cfg.scenes.size()) {
+                g_cyclePending = false;
+                QueueScene(g_cfg.scenes[sit->second]);
             }
             return 0;
         }
@@ -165,12 +448,8 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
         if (it != g_directById.end()) {
             for (size_t i = 0; i < g_cfg.inputs.size(); ++i) {
                 if (g_cfg.inputs[i].label == it->second) {
-                    if (SendInputCode(g_target, g_cfg.i2cSourceAddr.c_str(), g_cfg.inputs[i].code.c_str())) {
-                        g_cycleIndex = (int)i;
-                        Balloon(ToW(it->second).c_str());
-                    } else {
-                        Balloon(L"Switch failed (check I2C/target)");
-                    }
+                    g_cyclePending = false; // a direct pick wins over queued cycle presses
+                    QueueSwitch(g_cfg.inputs[i], (int)i, false);
                     break;
                 }
             }
@@ -178,6 +457,44 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
         }
         return 0;
     }
+    case WM_SWITCH_DONE: {
+        auto* done = reinterpret_cast<SwitchCompletion*>(lParam);
+
+        if (done->job.cycle && g_cycleInFlight) {
+            g_cycleInFlight = false;
+            if (g_cyclePending) {
+                // Presses arrived meanwhile: write only where they ended up
+                g_cyclePending = false;
+                auto ord = OrderedInputs(g_cfg);
+                if (g_cycleIndex >= 0 && g_cycleIndex < (int)ord.size() &&
+                    (g_cycleIndex != done->job.inputIndex || !done->ok)) {
+                    g_cycleInFlight = true;
+                    QueueSwitch(ord[g_cycleIndex], g_cycleIndex, true);
+                    delete done;
+                    return 0;
+                }
+            }
+        }
+
+        StoreLatencyProfiles(*done);
+        SaveMetrics(false);
+
+        if (done->job.scene) {
+            if (done->ok && done->job.inputIndex >= 0) g_cycleIndex = done->job.inputIndex;
+            SceneBalloon(*done);
+            delete done;
+            return 0;
+        }
+
+        if (done->ok) {
+            if (!done->job.cycle) g_cycleIndex = done->job.inputIndex;
+            SwitchedBalloon(done->job.label, done->results);
+        } else {
+            FailedBalloon(done->results);
+        }
+        delete done;
+        return 0;
+    }
     case WM_APP + 1: {
         if (lParam == WM_RBUTTONUP) {
             HMENU m = Menu();
@@ -207,25 +524,53 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             return 0;
         }
 
+        // Group selection: persist so the choice survives restarts
+        auto git = g_menuGroupIdToName.find(cmd);
+        if (git != g_menuGroupIdToName.end()) {
+            g_cfg.activeGroup = git->second;
+            g_targets = TargetsFromConfig(g_cfg);
+            SaveConfig(g_cfg);
+            return 0;
+        }
+
+        auto sit = g_menuSceneIdToIndex.find(cmd);
+        if (sit != g_menuSceneIdToIndex.end()) {
+            if (sit->second < g_cfg.scenes.size()) {
+                g_cyclePending = false;
+                QueueScene(g_cfg.scenes[sit->second]);
+            }
+            return 0;
+        }
+
         // Dynamic inputs
         auto mit = g_menuInputIdToIndex.find(cmd);
         if (mit != g_menuInputIdToIndex.end()) {
             size_t i = mit->second;
             if (i < g_cfg.inputs.size()) {
-                const auto& in = g_cfg.inputs[i];
-                if (SendInputCode(g_target, g_cfg.i2cSourceAddr.c_str(), in.code.c_str())) {
-                    g_cycleIndex = (int)i;
-                    Balloon(ToW(in.label).c_str());
-                } else {
-                    Balloon(L"Switch failed (check I2C/target)");
-                }
+                g_cyclePending = false;
+                QueueSwitch(g_cfg.inputs[i], (int)i, false);
             }
             return 0;
         }
 
         return 0;
     }
+    case WM_DISPLAYCHANGE:
+        // Monitors came or went; identities are re-resolved on the next switch
+        InvalidateDisplayMap();
+        RequestDisplayRefresh();
+        return 0;
+
+    case WM_DEVICECHANGE:
+        if (wParam == DBT_DEVNODES_CHANGED) RequestDisplayRefresh();
+        return TRUE;
+
     case WM_DESTROY:
+        StopSwitchQueue();
+        StopVcpCoalescer();
+        StopDisplayService();
+        if (g_latencyDirty) SaveConfig(g_cfg);
+        SaveMetrics(true);
         Shell_NotifyIcon(NIM_DELETE, &nid);
         if (nid.hIcon) DestroyIcon(nid.hIcon);
         PostQuitMessage(0);
@@ -237,7 +582,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
         if (LoadConfig(tmp)) {
             g_cfg = tmp;
             if (!g_cfg.targets.empty())
-                g_target = { g_cfg.targets[0].first, g_cfg.targets[0].second };
+                g_targets = TargetsFromConfig(g_cfg);
             UnregisterAllHotkeys(hwnd);
             RegisterHK(hwnd);
             Balloon(L"Settings saved");
@@ -251,6 +596,8 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
 }
 
 int RunTrayApp() {
+    g_startedAt = std::chrono::steady_clock::now();
+
     // Use WNDCLASSEX so we can set a small icon too
     WNDCLASSEX wc{};
     wc.cbSize = sizeof(wc);
@@ -0,0 +1,130 @@
+#include "display_service.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static std::thread g_worker;
+static std::mutex g_wakeLock;             // guards g_wakePending and g_stop
+static std::condition_variable g_wake;    // notified on every refresh request and on stop
+static bool g_wakePending = false;
+static bool g_stop = false;
+
+static std::mutex g_lock;                 // guards g_snapshot and g_listeners
+static DisplaySnapshot g_snapshot;
+#ifdef _WIN32
+static std::map<HWND, UINT> g_listeners;
+#endif
+
+// ---------- Worker ----------
+
+static bool SameDisplays(const std::vector<IdentifiedDisplay>& a, const std::vector<IdentifiedDisplay>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].adapterIdx != b[i].adapterIdx || a[i].displayIdx != b[i].displayIdx ||
+            a[i].name != b[i].name || a[i].id != b[i].id)
+            return false;
+    }
+    return true;
+}
+
+static void Refresh() {
+    std::vector<IdentifiedDisplay> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        previous = g_snapshot.displays;
+    }
+
+    const auto started = Clock::now();
+    auto displays = EnumerateIdentifiedDisplays(&previous);
+    const unsigned int ms = (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started).count();
+
+#ifdef _WIN32
+    std::map<HWND, UINT> notify;
+#endif
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        g_snapshot.lastRefreshMs = ms;
+        if (g_snapshot.generation != 0 && SameDisplays(g_snapshot.displays, displays)) return;
+        g_snapshot.displays = std::move(displays);
+        ++g_snapshot.generation;
+#ifdef _WIN32
+        notify = g_listeners;
+#endif
+    }
+
+    // Indices may have moved under stored identities
+    InvalidateDisplayMap();
+#ifdef _WIN32
+    for (const auto& kv : notify) PostMessage(kv.first, kv.second, 0, 0);
+#endif
+}
+
+static void WorkerMain() {
+    Refresh();
+    std::unique_lock<std::mutex> lock(g_wakeLock);
+    const auto woken = [] { return g_wakePending || g_stop; };
+    while (!g_stop) {
+        g_wake.wait(lock, woken);
+        // Let the burst finish before walking: every request restarts the quiet period
+        while (!g_stop) {
+            g_wakePending = false;
+            if (!g_wake.wait_for(lock, std::chrono::milliseconds(DISPLAY_REFRESH_SETTLE_MS), woken)) break;
+        }
+        if (g_stop) break;
+        lock.unlock();
+        Refresh();
+        lock.lock();
+    }
+}
+
+// ---------- Public API ----------
+
+bool StartDisplayService() {
+    if (g_worker.joinable()) return true;
+    {
+        std::lock_guard<std::mutex> lock(g_wakeLock);
+        g_stop = false;
+        g_wakePending = false;
+    }
+    g_worker = std::thread(WorkerMain);
+    return true;
+}
+
+void StopDisplayService() {
+    if (!g_worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(g_wakeLock);
+        g_stop = true;
+    }
+    g_wake.notify_one();
+    g_worker.join();
+}
+
+DisplaySnapshot GetDisplaySnapshot() {
+    std::lock_guard<std::mutex> lock(g_lock);
+    return g_snapshot;
+}
+
+void RequestDisplayRefresh() {
+    {
+        std::lock_guard<std::mutex> lock(g_wakeLock);
+        g_wakePending = true;
+    }
+    g_wake.notify_one();
+}
+
+#ifdef _WIN32
+void SubscribeDisplayChanges(HWND hwnd, UINT msg) {
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_listeners[hwnd] = msg;
+}
+
+void UnsubscribeDisplayChanges(HWND hwnd) {
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_listeners.erase(hwnd);
+}
+#endif
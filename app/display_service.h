@@ -0,0 +1,33 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <vector>
+#include "ddc_identity.h"
+
+// Connected displays, kept current by a background thread so the settings dialog never
+// walks the adapters itself.
+struct DisplaySnapshot {
+    std::vector<IdentifiedDisplay> displays;
+    unsigned long long generation = 0; // bumped whenever the list changes; 0 = first walk not done yet
+    unsigned int lastRefreshMs = 0;    // duration of the most recent walk
+};
+
+// Bursts of topology notifications (a dock reconnect sends dozens) collapse into one walk
+static const unsigned int DISPLAY_REFRESH_SETTLE_MS = 300;
+
+// Starts the worker and the initial walk. Returns immediately.
+bool StartDisplayService();
+void StopDisplayService();
+
+// Copy of the latest snapshot; never blocks on the walk.
+DisplaySnapshot GetDisplaySnapshot();
+
+// Topology may have changed (WM_DISPLAYCHANGE / WM_DEVICECHANGE). Safe from WndProc.
+void RequestDisplayRefresh();
+
+#ifdef _WIN32
+// Post `msg` to hwnd whenever the snapshot changes
+void SubscribeDisplayChanges(HWND hwnd, UINT msg);
+void UnsubscribeDisplayChanges(HWND hwnd);
+#endif
@@ -1,7 +1,9 @@
 ﻿#include "hotkeys.h"
 #include <algorithm>
 #include <cctype>
-#include <cstdlib>
+
+// Longest spec worth looking at: "CTRL+ALT+SHIFT+WIN+PAGEDOWN" is 27 characters
+static const size_t HOTKEY_SPEC_MAX = 64;
 
 static UINT ModFromToken(const std::string& t) {
     if (t == "CTRL") return MOD_CONTROL;
@@ -16,25 +18,48 @@ static UINT VkFromToken(const std::string& t) {
         if (c >= '0' && c <= '9') return 0x30 + (c - '0');
         if (c >= 'A' && c <= 'Z') return 0x41 + (c - 'A');
     }
-    if (t.size() > 1 && t[0] == 'F') {
-        int f = atoi(t.c_str() + 1);
+    // F1..F24: one or two digits and nothing else ("F1X" is not F1)
+    if ((t.size() == 2 || t.size() == 3) && t[0] == 'F' &&
+        std::all_of(t.begin() + 1, t.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        int f = std::stoi(t.substr(1));
         if (f >= 1 && f <= 24) return VK_F1 + (f - 1);
     }
+    if (t == "UP")       return VK_UP;
+    if (t == "DOWN")     return VK_DOWN;
+    if (t == "LEFT")     return VK_LEFT;
+    if (t == "RIGHT")    return VK_RIGHT;
+    if (t == "PAGEUP")   return VK_PRIOR;
+    if (t == "PAGEDOWN") return VK_NEXT;
     return 0;
 }
+// Modifiers plus exactly one key; unknown tokens, a second key or an empty token ("CTRL++1")
+// make the whole spec invalid rather than being skipped.
 bool ParseHotkey(const std::string& spec, HotkeySpec& out) {
     out = { 0,0 };
+    if (spec.size() > HOTKEY_SPEC_MAX) return false;
     std::string s = spec;
     std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
     size_t pos = 0, start = 0;
     while (true) {
         pos = s.find('+', start);
         std::string tok = (pos == std::string::npos) ? s.substr(start) : s.substr(start, pos - start);
-        if (tok.empty()) break;
-        UINT m = ModFromToken(tok);
-        if (m) out.fsModifiers |= m; else out.vk = VkFromToken(tok);
+        // "CTRL + ALT + 1" is fine too
+        tok.erase(0, tok.find_first_not_of(" \t"));
+        tok.erase(tok.find_last_not_of(" \t") + 1);
+        UINT m = tok.empty() ? 0 : ModFromToken(tok);
+        if (m) out.fsModifiers |= m;
+        else {
+            UINT vk = tok.empty() ? 0 : VkFromToken(tok);
+            if (!vk || out.vk) {
+                out = { 0,0 };
+                return false;
+            }
+            out.vk = vk;
+        }
         if (pos == std::string::npos) break;
         start = pos + 1;
     }
+    // Modifiers alone ("CTRL+ALT") aren't a hotkey either
+    if (!out.vk) out = { 0,0 };
     return out.vk != 0;
 }
@@ -1,7 +1,23 @@
 ﻿#pragma once
 #include <string>
+#ifdef _WIN32
 #include <windows.h>
+#else
+// Win32 values, so the parser also builds off Windows (bench/)
+typedef unsigned int UINT;
+#define MOD_ALT     0x0001
+#define MOD_CONTROL 0x0002
+#define MOD_SHIFT   0x0004
+#define MOD_WIN     0x0008
+#define VK_PRIOR    0x21
+#define VK_NEXT     0x22
+#define VK_LEFT     0x25
+#define VK_UP       0x26
+#define VK_RIGHT    0x27
+#define VK_DOWN     0x28
+#define VK_F1       0x70
+#endif
 
 struct HotkeySpec { UINT fsModifiers; UINT vk; };
 
-bool ParseHotkey(const std::string& spec, HotkeySpec& out); // "CTRL+ALT+F12"
+bool ParseHotkey(const std::string& spec, HotkeySpec& out); // "CTRL+ALT+F12", "CTRL+ALT+PAGEUP"
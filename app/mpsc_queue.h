@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+// Unbounded lock-free multi-producer / single-consumer queue (Vyukov style).
+// Push may be called from any thread; TryPop only from the one consumer thread.
+// The consumer always holds one "dummy" node whose value has already been taken.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() {
+        Node* stub = new Node();
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+    ~MpscQueue() {
+        T discard;
+        while (TryPop(discard)) {}
+        delete m_tail;
+    }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T value) {
+        Node* n = new Node();
+        n->value = std::move(value);
+        Node* prev = m_head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    // False when empty (or when a producer is between its exchange and its link; the
+    // producer's wake-up follows the link, so the consumer will look again).
+    bool TryPop(T& out) {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next->value);
+        m_tail = next;
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{ nullptr };
+        T value{};
+    };
+
+    std::atomic<Node*> m_head; // producers
+    Node* m_tail;              // consumer only
+};
@@ -12,120 +12,88 @@
 #include <set>
 #include <stdio.h> // for swprintf
 
-// Pull in ADL types / constants / globals
-#include "../amdddc/adl.h"        // has ADLPROCS, AdapterInfo, ADL_DISPLAY_* flags
+#include "display_service.h"      // cached display list with EDID identity
 
-extern bool InitADL();            // from adl.cpp
-
-// NOTE: This file MUST NOT mutate global ADL pointers (lpAdapterInfo, lpAdlDisplayInfo).
-// We allocate ONLY local ADL adapter/display structures to avoid stomping global state
-// used by the main app / hotkey thread.
-
-
-// Helper to pack/unpack adapter/display into a single pointer-sized value
-static inline LPARAM PackAD(int adapter, int display) {
-    return (LPARAM)((((unsigned long long)(unsigned int)adapter) & 0xFFFFFFFFull) |
-        ((((unsigned long long)(unsigned int)display) & 0xFFFFFFFFull) << 32));
-}
-static inline void UnpackAD(LPARAM v, int& adapter, int& display) {
-    adapter = (int)((unsigned int)(v & 0xFFFFFFFFull));
-    display = (int)((unsigned int)((v >> 32) & 0xFFFFFFFFull));
-}
+// Posted by the display service when the connected displays change while the dialog is open
+static const UINT WM_DISPLAYS_CHANGED = WM_APP + 10;
 
 struct TargetItem {
     int adapterIndex{};
     int displayIndex{};
+    EdidIdentity id;
     std::wstring label; // e.g., "Adapter 5 - LG ULTRAGEAR+ (Display 0)"
 };
 
 static std::vector<TargetItem> g_targets;
 
-// EnumerateTargets: use local ADL buffers only, do not touch global ADL memory.
-static void EnumerateTargets() {
+// EnumerateTargets: copy of the display service's snapshot. The walk itself (ADL adapter
+// and display info, EDID reads) runs on the service thread, so this never blocks the dialog.
+static bool EnumerateTargets() {
     g_targets.clear();
 
-    // Ensure ADL initialized (safe to call multiple times)
-    if (!InitADL()) return;
-
-    // Get number of adapters
-    int nAdapters = 0;
-    if (adlprocs.ADL_Adapter_NumberOfAdapters_Get(&nAdapters) != 0 || nAdapters <= 0) {
-        return;
-    }
-
-    // Allocate a local adapter info array
-    std::vector<AdapterInfo> localAdapters;
-    try {
-        localAdapters.resize(nAdapters);
-    } catch (...) {
-        return;
-    }
-    memset(localAdapters.data(), 0, sizeof(AdapterInfo) * nAdapters);
-
-    if (adlprocs.ADL_Adapter_AdapterInfo_Get(localAdapters.data(), sizeof(AdapterInfo) * nAdapters) != 0) {
-        return;
-    }
-
-    // For each adapter, fetch display info into a local display pointer
-    for (int i = 0; i < nAdapters; ++i) {
-        int displayCount = 0;
-        LPADLDisplayInfo localDisplayInfo = nullptr;
-
-        int adapterIndex = localAdapters[i].iAdapterIndex;
-        if (adlprocs.ADL_Display_DisplayInfo_Get(adapterIndex, &displayCount, &localDisplayInfo, 0) != 0) {
-            // failed for this adapter — continue
-            if (localDisplayInfo) { ADL_Main_Memory_Free((void**)&localDisplayInfo); localDisplayInfo = nullptr; }
-            continue;
-        }
-
-        if (!localDisplayInfo) continue;
-
-        for (int j = 0; j < displayCount; ++j) {
-            const auto& di = localDisplayInfo[j];
-
-            // Need both CONNECTED and MAPPED flags
-            const int required = ADL_DISPLAY_DISPLAYINFO_DISPLAYCONNECTED | ADL_DISPLAY_DISPLAYINFO_DISPLAYMAPPED;
-            if ((di.iDisplayInfoValue & required) != required)
-                continue;
+    DisplaySnapshot snap = GetDisplaySnapshot();
+    for (const auto& d : snap.displays) {
+        TargetItem t;
+        t.adapterIndex = d.adapterIdx;
+        t.displayIndex = d.displayIdx;
+        t.id = d.id;
 
-            // Ensure the display is mapped to this adapter (compare fields from localAdapters)
-            if (adapterIndex != di.displayID.iDisplayLogicalAdapterIndex)
-                continue;
+        std::wstring dispName = ToW(d.name);
+        std::wstringstream ss;
+        ss << L"Adapter " << t.adapterIndex << L" - " << dispName << L" (Display " << t.displayIndex << L")";
+        t.label = ss.str();
 
-            TargetItem t;
-            t.adapterIndex = adapterIndex;
-            t.displayIndex = di.displayID.iDisplayLogicalIndex;
-
-            std::wstring dispName = ToW(std::string(di.strDisplayName));
-            std::wstringstream ss;
-            ss << L"Adapter " << t.adapterIndex << L" - " << dispName << L" (Display " << t.displayIndex << L")";
-            t.label = ss.str();
-
-            g_targets.push_back(t);
-        }
-
-        // Free the local display info allocated by ADL
-        ADL_Main_Memory_Free((void**)&localDisplayInfo);
+        g_targets.push_back(t);
     }
+    return snap.generation != 0;
 }
 
-static void FillFromConfig(HWND hDlg, const AppConfig& cfg) {
-    // Monitor combo
+// Monitor combo. Prefers the display with want's identity, then its last known indices.
+static void FillMonitorCombo(HWND hDlg, const Target* want, bool ready) {
     HWND cb = GetDlgItem(hDlg, IDC_MONITOR);
     SendMessage(cb, CB_RESETCONTENT, 0, 0);
     int selectIndex = 0;
 
+    if (!ready) {
+        // First walk still running; the list fills in on WM_DISPLAYS_CHANGED
+        SendMessage(cb, CB_ADDSTRING, 0, (LPARAM)L"Detecting displays...");
+        SendMessage(cb, CB_SETCURSEL, 0, 0);
+        return;
+    }
+
+    bool matchedId = false;
     for (size_t i = 0; i < g_targets.size(); ++i) {
         const auto& t = g_targets[i];
         int idx = (int)SendMessage(cb, CB_ADDSTRING, 0, (LPARAM)t.label.c_str());
-        SendMessage(cb, CB_SETITEMDATA, idx, PackAD(t.adapterIndex, t.displayIndex));
-        if (!cfg.targets.empty() &&
-            t.adapterIndex == cfg.targets[0].first &&
-            t.displayIndex == cfg.targets[0].second) {
+        SendMessage(cb, CB_SETITEMDATA, idx, (LPARAM)i);
+        if (!want || matchedId) continue;
+        if (want->id.Valid() && t.id == want->id) {
+            selectIndex = idx;
+            matchedId = true;
+        } else if (t.adapterIndex == want->adapterIndex && t.displayIndex == want->displayIndex) {
             selectIndex = idx;
         }
     }
     SendMessage(cb, CB_SETCURSEL, selectIndex, 0);
+}
+
+// Display currently picked in the combo, if the list is populated
+static bool SelectedTarget(HWND hDlg, Target& out) {
+    if (g_targets.empty()) return false;
+    HWND cb = GetDlgItem(hDlg, IDC_MONITOR);
+    int idx = (int)SendMessage(cb, CB_GETCURSEL, 0, 0);
+    if (idx == CB_ERR) idx = 0;
+
+    size_t item = (size_t)SendMessage(cb, CB_GETITEMDATA, idx, 0);
+    if (item >= g_targets.size()) item = 0;
+    const TargetItem& picked = g_targets[item];
+    out = Target{ picked.adapterIndex, picked.displayIndex };
+    out.id = picked.id;
+    return true;
+}
+
+static void FillFromConfig(HWND hDlg, const AppConfig& cfg, bool ready) {
+    FillMonitorCombo(hDlg, cfg.targets.empty() ? nullptr : &cfg.targets[0], ready);
 
     auto hasLabel = [&](const std::string& label) {
         return std::find_if(cfg.inputs.begin(), cfg.inputs.end(), [&](const InputDef& x) { return x.label == label; }) != cfg.inputs.end();
@@ -205,16 +173,19 @@ static void MoveSelected(HWND lb, bool up) {
 }
 
 static bool CollectToConfig(HWND hDlg, AppConfig& io) {
-    // Monitor selection
-    HWND cb = GetDlgItem(hDlg, IDC_MONITOR);
-
-    if (!g_targets.empty()) {
-        int idx = (int)SendMessage(cb, CB_GETCURSEL, 0, 0);
-        if (idx == CB_ERR) idx = 0;
-
-        LPARAM data = SendMessage(cb, CB_GETITEMDATA, idx, 0);
-        int adapter = 0, display = 0; UnpackAD(data, adapter, display);
-        io.targets = { {adapter, display} };
+    // Monitor selection (unchanged while the display list is still being built)
+    Target t{};
+    if (SelectedTarget(hDlg, t)) {
+        // Only the default target is picked here; the rest back the groups in config.json
+        if (io.targets.empty()) io.targets.push_back(t);
+        else {
+            // Same monitor picked again: keep what was learned about it
+            const Target& prev = io.targets[0];
+            const bool same = (t.id.Valid() || prev.id.Valid()) ? t.id == prev.id
+                : (t.adapterIndex == prev.adapterIndex && t.displayIndex == prev.displayIndex);
+            if (same) t.latency = prev.latency;
+            io.targets[0] = t;
+        }
     }
 
     // Inputs with codes
@@ -277,9 +248,9 @@ static INT_PTR DlgProcCommon(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lParam,
     switch (msg) {
     case WM_INITDIALOG: {
         s_cfg = reinterpret_cast<AppConfig*>(lParam);
-        // Enumerate current targets (local-only)
-        EnumerateTargets();
-        FillFromConfig(hDlg, *s_cfg);
+        // Cached display list; refreshed in place if the service reports a change
+        SubscribeDisplayChanges(hDlg, WM_DISPLAYS_CHANGED);
+        FillFromConfig(hDlg, *s_cfg, EnumerateTargets());
 
         // Seed order list with currently checked inputs if empty
         HWND lb = GetDlgItem(hDlg, IDC_ORDER_LIST);
@@ -291,6 +262,18 @@ static INT_PTR DlgProcCommon(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lParam,
         }
         return TRUE;
     }
+    case WM_DISPLAYS_CHANGED: {
+        // Keep the user's pick if it is still connected
+        Target keep{};
+        const Target* want = SelectedTarget(hDlg, keep) ? &keep
+            : (s_cfg->targets.empty() ? nullptr : &s_cfg->targets[0]);
+        bool ready = EnumerateTargets();
+        FillMonitorCombo(hDlg, want, ready);
+        return TRUE;
+    }
+    case WM_DESTROY:
+        UnsubscribeDisplayChanges(hDlg);
+        return FALSE;
     case WM_COMMAND: {
         switch (LOWORD(wParam)) {
         case IDC_ORDER_UP:   MoveSelected(GetDlgItem(hDlg, IDC_ORDER_LIST), true);  return TRUE;
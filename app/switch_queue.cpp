@@ -0,0 +1,127 @@
+#include "switch_queue.h"
+#include "app_toggle.h"
+#include "ddc_metrics.h"
+#include "mpsc_queue.h"
+#include <atomic>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static MpscQueue<SwitchJob*> g_queue;
+static std::thread g_worker;
+static HANDLE g_wake = nullptr;           // auto-reset; signalled after every push
+static std::atomic<bool> g_stop{ false };
+static HWND g_notifyWnd = nullptr;
+static UINT g_doneMsg = 0;
+
+// ---------- Stats ----------
+
+static std::atomic<unsigned long long> g_enqueued{ 0 };
+static std::atomic<unsigned long long> g_completed{ 0 };
+static std::atomic<int> g_depth{ 0 };
+static std::atomic<int> g_maxDepth{ 0 };
+static std::atomic<unsigned int> g_lastWaitMs{ 0 };
+static std::atomic<unsigned int> g_maxWaitMs{ 0 };
+static std::atomic<unsigned long long> g_totalWaitMs{ 0 };
+
+template <typename T>
+static void StoreMax(std::atomic<T>& a, T v) {
+    T cur = a.load(std::memory_order_relaxed);
+    while (v > cur && !a.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+}
+
+static unsigned int MsBetween(Clock::time_point a, Clock::time_point b) {
+    return (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+}
+
+static std::uint64_t UsBetween(Clock::time_point a, Clock::time_point b) {
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(b - a).count();
+}
+
+// ---------- Worker ----------
+
+static void RunJob(SwitchJob* job) {
+    auto* done = new SwitchCompletion();
+    const auto started = Clock::now();
+    done->waitMs = MsBetween(job->enqueuedAt, started);
+    RecordDdcLatencyUs(DdcMetric::queueWait, UsBetween(job->enqueuedAt, started));
+
+    if (job->scene) {
+        done->ok = ApplySceneToGroup(job->targets, job->i2cAddr.c_str(), job->code.c_str(),
+            job->valueI2cAddr.c_str(), job->values, done->sceneResults, &done->profiles);
+        for (const auto& r : done->sceneResults) done->results.push_back(r.input);
+    } else {
+        done->ok = SendInputCodeToGroup(job->targets, job->i2cAddr.c_str(), job->code.c_str(),
+            done->results, &done->profiles);
+    }
+    const auto finished = Clock::now();
+    done->runMs = MsBetween(started, finished);
+    RecordDdcLatencyUs(DdcMetric::endToEnd, UsBetween(job->enqueuedAt, finished));
+    done->job = std::move(*job);
+    delete job;
+
+    g_lastWaitMs.store(done->waitMs, std::memory_order_relaxed);
+    StoreMax(g_maxWaitMs, done->waitMs);
+    g_totalWaitMs.fetch_add(done->waitMs, std::memory_order_relaxed);
+    g_completed.fetch_add(1, std::memory_order_relaxed);
+    g_depth.fetch_sub(1, std::memory_order_relaxed);
+
+    if (!PostMessage(g_notifyWnd, g_doneMsg, 0, (LPARAM)done)) delete done;
+}
+
+static void WorkerMain() {
+    while (!g_stop.load(std::memory_order_acquire)) {
+        SwitchJob* job = nullptr;
+        if (g_queue.TryPop(job)) {
+            RunJob(job);
+            continue;
+        }
+        WaitForSingleObject(g_wake, INFINITE);
+    }
+}
+
+// ---------- Public API ----------
+
+bool StartSwitchQueue(HWND hwnd, UINT doneMsg) {
+    if (g_worker.joinable()) return true;
+    g_notifyWnd = hwnd;
+    g_doneMsg = doneMsg;
+    g_wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!g_wake) return false;
+    g_stop.store(false, std::memory_order_release);
+    g_worker = std::thread(WorkerMain);
+    return true;
+}
+
+void StopSwitchQueue() {
+    if (!g_worker.joinable()) return;
+    g_stop.store(true, std::memory_order_release);
+    SetEvent(g_wake);
+    g_worker.join();
+
+    SwitchJob* job = nullptr;
+    while (g_queue.TryPop(job)) delete job;
+    g_depth.store(0, std::memory_order_relaxed);
+    CloseHandle(g_wake);
+    g_wake = nullptr;
+}
+
+void EnqueueSwitch(SwitchJob job) {
+    job.enqueuedAt = Clock::now();
+    g_enqueued.fetch_add(1, std::memory_order_relaxed);
+    StoreMax(g_maxDepth, g_depth.fetch_add(1, std::memory_order_relaxed) + 1);
+    g_queue.Push(new SwitchJob(std::move(job)));
+    SetEvent(g_wake);
+}
+
+SwitchQueueStats GetSwitchQueueStats() {
+    SwitchQueueStats s;
+    s.enqueued = g_enqueued.load(std::memory_order_relaxed);
+    s.completed = g_completed.load(std::memory_order_relaxed);
+    s.depth = g_depth.load(std::memory_order_relaxed);
+    s.maxDepth = g_maxDepth.load(std::memory_order_relaxed);
+    s.lastWaitMs = g_lastWaitMs.load(std::memory_order_relaxed);
+    s.maxWaitMs = g_maxWaitMs.load(std::memory_order_relaxed);
+    s.totalWaitMs = g_totalWaitMs.load(std::memory_order_relaxed);
+    return s;
+}
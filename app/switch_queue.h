@@ -0,0 +1,53 @@
+#pragma once
+#include <windows.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "amdddc_core.h"
+#include "ddc_scene.h"
+
+// One input switch for a set of displays, queued from the UI thread
+struct SwitchJob {
+    std::vector<Target> targets;
+    std::string i2cAddr;
+    std::string code;      // e.g. "0xD1"; empty in a scene without an input
+    std::string label;     // shown in the completion balloon
+    int inputIndex = -1;   // index into AppConfig::inputs (or the cycle order) it selects
+    bool cycle = false;
+    bool scene = false;    // apply `values` (and `code`, if any) as one scene
+    std::vector<DdcSceneValue> values;
+    std::string valueI2cAddr;
+    std::chrono::steady_clock::time_point enqueuedAt;
+};
+
+// Posted back to the window (lParam = SwitchCompletion*, receiver deletes it)
+struct SwitchCompletion {
+    SwitchJob job;
+    bool ok = false;
+    std::vector<DdcSwitchResult> results; // one per job.targets entry
+    std::vector<DdcLatencyProfile> profiles; // learned latency per job.targets entry, after this switch
+    std::vector<DdcSceneResult> sceneResults; // scenes only; results[i] is sceneResults[i].input
+    unsigned int waitMs = 0;              // time spent queued
+    unsigned int runMs = 0;               // time spent switching
+};
+
+struct SwitchQueueStats {
+    unsigned long long enqueued = 0;
+    unsigned long long completed = 0;
+    int depth = 0;                         // queued + in flight
+    int maxDepth = 0;
+    unsigned int lastWaitMs = 0;
+    unsigned int maxWaitMs = 0;
+    unsigned long long totalWaitMs = 0;
+};
+
+// Starts the I/O worker. Completions are posted to hwnd as `doneMsg`.
+bool StartSwitchQueue(HWND hwnd, UINT doneMsg);
+// Stops the worker after the job in flight; anything still queued is dropped.
+void StopSwitchQueue();
+
+// Never blocks on DDC: safe to call from WndProc.
+void EnqueueSwitch(SwitchJob job);
+
+SwitchQueueStats GetSwitchQueueStats();
@@ -1,12 +1,27 @@
 #pragma once
 #include <string>
+#include "ddc_edid.h"
+#include "ddc_latency.h"
 
 struct Target {
-    int adapterIndex;
-    int displayIndex;
+    int adapterIndex = 0;
+    int displayIndex = 0;
+    EdidIdentity id = {};                // when valid, the indices above are only where it was last seen
+    unsigned int settleDeadlineMs = 700; // longest wait for the monitor to confirm a switch
+    DdcLatencyProfile latency = {};      // learned time to confirm a switch, persisted per target
+    int configIndex = -1;                // index into AppConfig::targets it was taken from
 };
 
 struct InputDef {
     std::string label; // e.g., "DisplayPort"
     std::string code;  // e.g., "0xD0"
 };
+
+// Continuous VCP control driven by an up/down hotkey pair
+struct ControlDef {
+    std::string label;  // e.g., "Brightness"
+    std::string code;   // VCP code, e.g., "0x10"
+    int step = 5;       // per key press, in the monitor's units (usually 0-100)
+    std::string up;     // hotkeys, e.g., "CTRL+ALT+PAGEUP"; empty = none
+    std::string down;
+};
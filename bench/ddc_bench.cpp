@@ -0,0 +1,248 @@
+// Microbenchmarks for the switching core and the config paths.
+//
+// Builds with any C++17 compiler, no Windows headers needed. From the repository root:
+//   g++ -O2 -std=c++17 -Iamdddc -o ddc_bench bench/ddc_bench.cpp app/app_config.cpp app/hotkeys.cpp
+//       $(ls amdddc/*.cpp | grep -v amdddc-windows) -lpthread
+// (one command line)
+//
+// Prints one JSON array on stdout (name, iterations, ns per op: median / p10 / p90 / min over
+// the timed batches) and a readable summary on stderr. Pass a name prefix to run a subset
+// ("ddc_bench config/"), --quick for fewer batches.
+//
+// config/LoadConfig reads config.json next to the binary: an existing one is benchmarked
+// as it is, otherwise one is written for the run and removed afterwards.
+
+#include "../app/app_config.h"
+#include "../app/hotkeys.h"
+#include "amdddc_core.h"
+#include "ddc_frame.h"
+#include "ddc_identity.h"
+#include "ddc_reply.h"
+#include "ddc_server.h"
+#include "ddc_transport.h"
+#include "../external/json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using nlohmann::json;
+
+// Keeps results alive so the optimizer can't drop the work
+static volatile unsigned long long g_sink;
+
+struct BenchResult {
+    std::string name;
+    unsigned long long iterations = 0;
+    double medianNs = 0, p10Ns = 0, p90Ns = 0, minNs = 0;
+};
+
+static std::vector<BenchResult> g_results;
+static std::string g_filter;
+static int g_batches = 30;
+
+// Runs op in batches of `batch` calls and reports the per-call time of each batch
+static void Bench(const std::string& name, unsigned long long batch, const std::function<void()>& op)
+{
+    if (!g_filter.empty() && name.compare(0, g_filter.size(), g_filter) != 0) return;
+
+    for (unsigned long long i = 0; i < batch; ++i) op(); // warm up
+
+    std::vector<double> perOp;
+    for (int b = 0; b < g_batches; ++b) {
+        const auto t0 = Clock::now();
+        for (unsigned long long i = 0; i < batch; ++i) op();
+        const auto t1 = Clock::now();
+        perOp.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / (double)batch);
+    }
+    std::sort(perOp.begin(), perOp.end());
+
+    BenchResult r;
+    r.name = name;
+    r.iterations = batch * (unsigned long long)g_batches;
+    r.minNs = perOp.front();
+    r.p10Ns = perOp[perOp.size() / 10];
+    r.medianNs = perOp[perOp.size() / 2];
+    r.p90Ns = perOp[perOp.size() * 9 / 10];
+    g_results.push_back(r);
+
+    std::fprintf(stderr, "%-32s %14.1f ns/op  (p10 %.1f, p90 %.1f)\n", name.c_str(), r.medianNs, r.p10Ns, r.p90Ns);
+}
+
+// A config with everything in use: two targets with learned latency, a group, controls, scenes
+static AppConfig SampleConfig()
+{
+    AppConfig c;
+    LoadConfig(c); // defaults when there's no config.json
+    Target second{ 5, 1 };
+    second.configIndex = 1;
+    for (unsigned int ms : { 140u, 152u, 161u, 149u, 170u, 158u }) {
+        c.targets[0].latency.Add(ms);
+        second.latency.Add(ms + 90);
+    }
+    c.targets.push_back(second);
+    c.groups = { { "Both", { 0, 1 } } };
+    c.activeGroup = "Both";
+    c.scenes = {
+        { "Laptop", "USB-C", { { "0x10", 40 }, { "0x62", 20 } }, "CTRL+ALT+L" },
+        { "Desktop", "DisplayPort", { { "0x10", 70 } }, "CTRL+ALT+D" }
+    };
+    return c;
+}
+
+static void FrameBenches()
+{
+    // volatile inputs keep the constexpr builders from folding to constants
+    volatile unsigned char code = 0xF4;
+    volatile unsigned int value = 0xD1;
+    Bench("frame/MakeSetVcpFrame", 100000, [&] {
+        const auto f = MakeSetVcpFrame(0x50, code, value);
+        g_sink = g_sink + f[SET_CHK_OFFSET];
+    });
+
+    unsigned char buf[36];
+    for (int i = 0; i < (int)sizeof(buf); ++i) buf[i] = (unsigned char)(i * 37 + 11);
+    Bench("frame/DdcChecksum36", 100000, [&] {
+        buf[0] = code;
+        g_sink = g_sink + DdcChecksum(buf, sizeof(buf), 0x50);
+    });
+
+    // Get VCP reply for 0xF4: current 0xD1 of max 0xFF
+    unsigned char reply[11] = { 0x6E, 0x88, 0x02, 0x00, 0xF4, 0x00, 0x00, 0xFF, 0x00, 0xD1, 0x00 };
+    reply[10] = DdcChecksum(reply, 10, 0x50);
+    Bench("reply/ParseGetVcpReply", 100000, [&] {
+        DdcReplyParser parser;
+        parser.Feed(reply, (int)sizeof(reply));
+        VcpReply out;
+        g_sink = g_sink + (unsigned long long)DecodeGetVcpReply(parser, code, out) + out.cur;
+    });
+}
+
+static void HotkeyBenches()
+{
+    const std::string specs[] = { "CTRL+ALT+1", "ctrl+alt+pageup", "CTRL+SHIFT+F12", "WIN+ALT+RIGHT" };
+    size_t i = 0;
+    Bench("hotkey/ParseHotkey", 100000, [&] {
+        HotkeySpec hk;
+        g_sink = g_sink + (ParseHotkey(specs[i++ & 3], hk) ? hk.vk : 0);
+    });
+}
+
+static void ConfigBenches()
+{
+    const AppConfig cfg = SampleConfig();
+    const std::string text = ConfigToJson(cfg);
+
+    Bench("config/OrderedInputs", 20000, [&] {
+        g_sink = g_sink + OrderedInputs(cfg).size();
+    });
+    Bench("config/ToJson", 2000, [&] {
+        g_sink = g_sink + ConfigToJson(cfg).size();
+    });
+    Bench("config/ParseJsonToConfig", 2000, [&] {
+        AppConfig out;
+        g_sink = g_sink + (ConfigFromJson(text, out) ? out.targets.size() : 0);
+    });
+
+    const std::string path = ConfigPath();
+    const bool wrote = !std::filesystem::exists(path);
+    if (wrote) std::ofstream(path, std::ios::binary) << text;
+    Bench("config/LoadConfig", 500, [&] {
+        AppConfig out;
+        g_sink = g_sink + (LoadConfig(out) ? out.targets.size() : 0);
+    });
+    if (wrote) std::filesystem::remove(path);
+}
+
+// Topology walk (adapters, displays, one EDID read and parse per display) over three
+// simulated displays on two adapters
+static void TopologyBenches()
+{
+    SimTransportOptions opts;
+    opts.displays = { { 5, 0 }, { 5, 1 }, { 6, 0 } };
+    SetActiveTransport(CreateSimTransport(opts));
+
+    Bench("topology/EnumerateTopology", 2000, [&] {
+        g_sink = g_sink + EnumerateTopology().size();
+    });
+}
+
+// Round trip to a serve daemon in this process: framing and the local socket / pipe, no
+// bus traffic. What a scripted switch costs on top of the switch itself.
+static void ServerBenches()
+{
+    const std::string endpoint = DefaultDdcServerEndpoint() + "-bench";
+    std::thread server([&] { RunDdcServer(endpoint); });
+
+    DdcServerClient client;
+    for (int i = 0; i < 100 && !client.Connect(endpoint); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    DdcServerRequest req{};
+    req.op = (std::uint8_t)DdcServerOp::ping;
+    Bench("serve/ping_roundtrip", 2000, [&] {
+        DdcServerReply reply;
+        g_sink = g_sink + (client.Call(req, reply) ? reply.op + 1 : 0);
+    });
+
+    client.Close();
+    StopDdcServer();
+    server.join();
+}
+
+// Full switch against the simulated monitor: pre-read, write, settle readback. Bus pacing
+// (DDC_WRITE_GAP_MS between messages) is included, so this is milliseconds, not nanoseconds.
+static void SwitchBenches()
+{
+    SimTransportOptions opts;
+    opts.model.switchMs = 100;
+    SetActiveTransport(CreateSimTransport(opts));
+
+    unsigned int next = 0xD0;
+    const int saved = g_batches;
+    g_batches = std::min(g_batches, 10);
+    Bench("switch/sim_end_to_end", 2, [&] {
+        DdcSwitchResult res{};
+        SetVcpFeatureWithI2cAddrEx(5, 0, 0xF4, next, 0x50, 700, &res);
+        next ^= 0x01;
+        g_sink = g_sink + res.confirmed;
+    });
+    g_batches = saved;
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) g_batches = 5;
+        else g_filter = argv[i];
+    }
+
+    FrameBenches();
+    HotkeyBenches();
+    ConfigBenches();
+    TopologyBenches();
+    ServerBenches();
+    SwitchBenches();
+
+    json out = json::array();
+    for (const auto& r : g_results) {
+        out.push_back({
+            { "name", r.name },
+            { "iterations", r.iterations },
+            { "nsPerOp", r.medianNs },
+            { "p10Ns", r.p10Ns },
+            { "p90Ns", r.p90Ns },
+            { "minNs", r.minNs }
+        });
+    }
+    std::cout << out.dump(2) << std::endl;
+    return 0;
+}
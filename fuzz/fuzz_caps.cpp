@@ -0,0 +1,18 @@
+// Fuzz target: ParseCapabilities (amdddc/ddc_caps.h).
+//
+// Input: a capabilities string as reassembled from the display's 0xE3 fragments, which
+// may be truncated, unbalanced or padded with garbage from the bus.
+// Build and run: see "Fuzzing" in README.md.
+
+#include "ddc_caps.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    DdcCapabilities caps;
+    ParseCapabilities(std::string((const char*)data, size), caps);
+    for (const auto& kv : caps.vcp) caps.SupportsVcp(kv.first);
+    return 0;
+}
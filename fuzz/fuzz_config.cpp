@@ -0,0 +1,24 @@
+// Fuzz target: ConfigFromJson (app/app_config.h).
+//
+// Input: the contents of config.json. Whatever parses must survive a round trip: what
+// SaveConfig would write has to load again and write back the same text.
+// Build and run: see "Fuzzing" in README.md.
+
+#include "../app/app_config.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    AppConfig cfg;
+    if (!ConfigFromJson(std::string((const char*)data, size), cfg)) return 0;
+    OrderedInputs(cfg);
+
+    const std::string saved = ConfigToJson(cfg);
+    AppConfig reloaded;
+    if (!ConfigFromJson(saved, reloaded)) std::abort();
+    if (ConfigToJson(reloaded) != saved) std::abort();
+    return 0;
+}
@@ -0,0 +1,39 @@
+// Fuzz target: DdcReplyParser and DecodeGetVcpReply (amdddc/ddc_reply.h).
+//
+// Input: byte 0 is the VCP code the reply is decoded for, the rest is what the display sent.
+// The bytes are fed once in one call and once a byte at a time; both must end in the same
+// state with the same payload, since the driver may hand a reply over in pieces.
+// Build and run: see "Fuzzing" in README.md.
+
+#include "ddc_reply.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    if (size < 1) return 0;
+    const unsigned char vcpCode = data[0];
+    const unsigned char* reply = data + 1;
+    const int len = (int)(size - 1);
+
+    DdcReplyParser whole;
+    whole.Feed(reply, len);
+
+    DdcReplyParser bytewise;
+    for (int i = 0; i < len; ++i) bytewise.Feed(reply[i]);
+
+    if (whole.state() != bytewise.state() || whole.error() != bytewise.error()) std::abort();
+    if (whole.state() == DdcReplyParser::State::complete) {
+        if (whole.PayloadLen() < 0 || whole.PayloadLen() > DDC_MAX_REPLY_PAYLOAD) std::abort();
+        if (whole.PayloadLen() != bytewise.PayloadLen() ||
+            std::memcmp(whole.Payload(), bytewise.Payload(), (std::size_t)whole.PayloadLen()) != 0)
+            std::abort();
+    }
+
+    VcpReply out;
+    const int rc = DecodeGetVcpReply(whole, vcpCode, out);
+    if (rc == 0 && out.code != vcpCode) std::abort();
+    return 0;
+}
@@ -0,0 +1,21 @@
+// Fuzz target: ParseHotkey (app/hotkeys.h).
+//
+// Input: a hotkey spec from config.json, e.g. "CTRL+ALT+PAGEUP". Run with -timeout so a
+// spec that makes the tokenizer crawl is reported, not just one that crashes it.
+// Build and run: see "Fuzzing" in README.md.
+
+#include "../app/hotkeys.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    HotkeySpec spec;
+    const bool ok = ParseHotkey(std::string((const char*)data, size), spec);
+    // A spec is all or nothing: exactly one key, or nothing at all
+    if (ok && spec.vk == 0) std::abort();
+    if (!ok && (spec.vk != 0 || spec.fsModifiers != 0)) std::abort();
+    return 0;
+}
@@ -0,0 +1,46 @@
+// Replays files (or every file in a directory) through a fuzz target once, for compilers
+// without libFuzzer: link it with a fuzz_*.cpp instead of -fsanitize=fuzzer to check the
+// seed corpus or a crash reproducer under ASan/UBSan. Exits non-zero if a file can't be read.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+static bool RunFile(const std::filesystem::path& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        std::fprintf(stderr, "cannot read %s\n", path.string().c_str());
+        return false;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput((const std::uint8_t*)bytes.data(), bytes.size());
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 0;
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        const std::filesystem::path arg(argv[i]);
+        if (std::filesystem::is_directory(arg)) {
+            for (const auto& e : std::filesystem::directory_iterator(arg)) {
+                if (!e.is_regular_file()) continue;
+                ok = RunFile(e.path()) && ok;
+                ++runs;
+            }
+        } else {
+            ok = RunFile(arg) && ok;
+            ++runs;
+        }
+    }
+    std::printf("%d inputs\n", runs);
+    return ok ? 0 : 1;
+}
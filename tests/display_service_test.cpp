@@ -0,0 +1,151 @@
+// Timing test for the display service (app/display_service.h) against the ADL mock, with
+// ADL_Display_DisplayInfo_Get made slow enough that a blocking caller would show.
+//
+// Builds with any C++17 compiler, no Windows headers needed. From the repository root:
+//   g++ -O2 -std=c++17 -Iamdddc -o display_service_test tests/display_service_test.cpp
+//       app/display_service.cpp $(ls amdddc/*.cpp | grep -v amdddc-windows) -lpthread
+// (one command line)
+//
+// Checks that
+//   - GetDisplaySnapshot hands out the cached snapshot while a walk is in flight;
+//   - a burst of RequestDisplayRefresh calls (a dock reconnect) collapses into one walk;
+//   - a walk that finds the same displays keeps their identities without reading EDID.
+// Prints one line per check; exits 1 if any failed.
+
+#include "../app/display_service.h"
+#include "adl_mock.h"
+#include "ddc_transport.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static const unsigned int SLOW_DISPLAY_INFO_MS = 150;
+
+static const char* MOCK_SCRIPT = R"({
+  "adapters": [
+    { "index": 5, "bus": 3, "name": "AMD Radeon RX 7800 XT",
+      "displays": [ { "index": 0, "name": "LG ULTRAGEAR+", "manufacturer": "GSM", "product": 23465, "serial": 1 },
+                    { "index": 1, "name": "LG HDR 4K", "manufacturer": "GSM", "product": 30470, "serialText": "204NTABC1234" } ] },
+    { "index": 6, "bus": 3, "name": "AMD Radeon RX 7800 XT" }
+  ],
+  "calls": { "ADL_Display_DisplayInfo_Get": { "latencyUs": 150000 } }
+})";
+
+static int g_failures = 0;
+
+static void Check(bool ok, const std::string& what)
+{
+    std::printf("%s  %s\n", ok ? "ok  " : "FAIL", what.c_str());
+    if (!ok) ++g_failures;
+}
+
+static unsigned long long Calls(const char* fn)
+{
+    const auto stats = GetAdlMockStats();
+    auto it = stats.find(fn);
+    return it == stats.end() ? 0 : it->second.calls;
+}
+
+static double MsSince(Clock::time_point from)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+}
+
+// Polls until pred holds or timeoutMs passes
+static bool WaitFor(const std::function<bool()>& pred, unsigned int timeoutMs)
+{
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!pred()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+// Slowest GetDisplaySnapshot over `forMs` of calls
+static double SlowestSnapshotMs(unsigned int forMs)
+{
+    double slowest = 0;
+    const auto until = Clock::now() + std::chrono::milliseconds(forMs);
+    while (Clock::now() < until) {
+        const auto started = Clock::now();
+        GetDisplaySnapshot();
+        const double ms = MsSince(started);
+        if (ms > slowest) slowest = ms;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return slowest;
+}
+
+int main()
+{
+    AdlMockConfig mock;
+    std::string err;
+    if (!ParseAdlMockScript(MOCK_SCRIPT, mock, &err)) {
+        std::fprintf(stderr, "mock script: %s\n", err.c_str());
+        return 1;
+    }
+    InstallAdlMock(mock);
+    SetActiveTransport(CreateAdlTransport());
+    if (!ActiveTransport()->Open()) {
+        std::fprintf(stderr, "could not open the ADL transport on the mock\n");
+        return 1;
+    }
+
+    // First walk: the snapshot is readable (and empty) while it runs
+    const auto started = Clock::now();
+    StartDisplayService();
+    Check(MsSince(started) < SLOW_DISPLAY_INFO_MS / 2, "StartDisplayService returns before the first walk");
+    Check(GetDisplaySnapshot().generation == 0, "snapshot is generation 0 while the first walk runs");
+    Check(SlowestSnapshotMs(SLOW_DISPLAY_INFO_MS / 2) < 10, "GetDisplaySnapshot doesn't wait for the first walk");
+    Check(WaitFor([] { return GetDisplaySnapshot().generation == 1; }, 5000), "first walk publishes generation 1");
+
+    const DisplaySnapshot first = GetDisplaySnapshot();
+    Check(first.displays.size() == 2, "first walk finds both displays");
+    bool allIdentified = !first.displays.empty();
+    for (const auto& d : first.displays) allIdentified = allIdentified && d.id.Valid();
+    Check(allIdentified, "first walk reads every identity");
+
+    const unsigned long long infoPerWalk = Calls("ADL_Display_DisplayInfo_Get");
+    const unsigned long long edidBefore = Calls("ADL_Display_EdidData_Get");
+    Check(infoPerWalk > 0 && edidBefore == first.displays.size(), "first walk reads EDID once per display");
+
+    // Burst: 20 requests 10 ms apart, all inside the settle window of the one before
+    for (int i = 0; i < 20; ++i) {
+        RequestDisplayRefresh();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    Check(Calls("ADL_Display_DisplayInfo_Get") == infoPerWalk, "no walk while the burst is still going");
+
+    // The walk starts DISPLAY_REFRESH_SETTLE_MS after the last request; read snapshots through it
+    const double slowest = SlowestSnapshotMs(DISPLAY_REFRESH_SETTLE_MS + SLOW_DISPLAY_INFO_MS);
+    Check(Calls("ADL_Display_DisplayInfo_Get") > infoPerWalk, "the burst triggers a walk");
+    Check(slowest < 10, "GetDisplaySnapshot doesn't wait for a refresh walk (slowest " +
+        std::to_string((int)slowest) + " ms)");
+    Check(WaitFor([&] { return Calls("ADL_Display_DisplayInfo_Get") >= 2 * infoPerWalk; }, 5000),
+        "the refresh walk completes");
+
+    // Give a second (wrong) walk time to start before counting
+    std::this_thread::sleep_for(std::chrono::milliseconds(DISPLAY_REFRESH_SETTLE_MS + SLOW_DISPLAY_INFO_MS));
+    Check(Calls("ADL_Display_DisplayInfo_Get") == 2 * infoPerWalk, "20 requests collapse into one walk");
+
+    const DisplaySnapshot second = GetDisplaySnapshot();
+    Check(second.generation == first.generation, "unchanged displays don't bump the generation");
+    Check(Calls("ADL_Display_EdidData_Get") == edidBefore, "unchanged displays keep their identity without an EDID read");
+    bool sameIds = second.displays.size() == first.displays.size();
+    for (size_t i = 0; sameIds && i < first.displays.size(); ++i)
+        sameIds = second.displays[i].id == first.displays[i].id;
+    Check(sameIds, "identities are carried over");
+
+    const auto stopStarted = Clock::now();
+    StopDisplayService();
+    Check(MsSince(stopStarted) < DISPLAY_REFRESH_SETTLE_MS, "StopDisplayService returns without waiting out the settle time");
+
+    RemoveAdlMock();
+    std::printf("%s\n", g_failures ? "FAILED" : "passed");
+    return g_failures ? 1 : 0;
+}